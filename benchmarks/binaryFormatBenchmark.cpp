@@ -0,0 +1,198 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+#include "include/binary.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+
+using Clock = std::chrono::steady_clock;
+
+using Token = TSys::JsonReader::Token;
+
+
+static constexpr auto Duration = std::chrono::milliseconds(500);
+
+static constexpr size_t DefaultValueCount = 10000;
+
+
+// Any values of the default types, as a graph of mixed parameters.
+static std::vector<std::any> Values(size_t count)
+{
+    TSys::Enum en(std::vector<std::string>{"linear", "smooth", "step", "constant"}, 2);
+
+    std::vector<std::any> values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        switch (i % 5)
+        {
+            case 0:
+                values.push_back(std::make_any<TSys::AnyValue>(TSys::AnyValue((int)i)));
+                break;
+
+            case 1:
+                values.push_back(std::make_any<TSys::AnyValue>(TSys::AnyValue(i * 0.25)));
+                break;
+
+            case 2:
+                values.push_back(std::make_any<TSys::AnyValue>(TSys::AnyValue(i % 2 == 0)));
+                break;
+
+            case 3:
+                values.push_back(std::make_any<TSys::AnyValue>(
+                        TSys::AnyValue(std::string("parameter ") + std::to_string(i))));
+                break;
+
+            default:
+                values.push_back(std::make_any<TSys::AnyValue>(TSys::AnyValue(en)));
+                break;
+        }
+    }
+
+    return values;
+}
+
+
+static void Write(const std::vector<std::any>& values, TSys::JsonWriter& writer)
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<TSys::AnyValue>();
+
+    writer.StartArray();
+    for (const auto& value : values)
+    {
+        handler->WriteValue(value, writer);
+    }
+    writer.EndArray(0);
+}
+
+
+static size_t Read(TSys::JsonReader& reader, size_t count)
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<TSys::AnyValue>();
+
+    if (!reader.Next() || !reader.Consume(Token::StartArray))
+    {
+        std::abort();
+    }
+
+    size_t read = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        std::any value = handler->ReadValue(handler->InitValue(), reader);
+        read += value.has_value();
+    }
+
+    if (!reader.Consume(Token::EndArray) || reader.HasError())
+    {
+        std::abort();
+    }
+
+    return read;
+}
+
+
+static std::string WriteJson(const std::vector<std::any>& values)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    TSys::JsonWriterAdapter<rapidjson::Writer<rapidjson::StringBuffer>> adapter(writer);
+
+    Write(values, adapter);
+
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+
+static size_t ReadJson(const std::string& data, size_t count)
+{
+    rapidjson::StringStream stream(data.c_str());
+    TSys::JsonReaderAdapter<rapidjson::StringStream> reader(stream);
+
+    return Read(reader, count);
+}
+
+
+static std::string WriteBinary(const std::vector<std::any>& values)
+{
+    std::string data;
+    TSys::BinaryWriter writer(data);
+
+    Write(values, writer);
+
+    return data;
+}
+
+
+static size_t ReadBinary(const std::string& data, size_t count)
+{
+    TSys::BinaryReader reader(data);
+
+    return Read(reader, count);
+}
+
+
+// Runs function until Duration elapsed, returns runs per second.
+template<class F>
+static double Measure(F&& function)
+{
+    size_t runs = 0;
+
+    auto start = Clock::now();
+    std::chrono::duration<double> elapsed{};
+    do
+    {
+        function();
+        runs++;
+        elapsed = Clock::now() - start;
+    } while (elapsed < Duration);
+
+    return static_cast<double>(runs) / elapsed.count();
+}
+
+
+static void Report(const char* format, const std::vector<std::any>& values,
+                   std::string (*write)(const std::vector<std::any>&),
+                   size_t (*read)(const std::string&, size_t))
+{
+    std::string data = write(values);
+    if (read(data, values.size()) != values.size())
+    {
+        std::abort();
+    }
+
+    double writes = Measure([&]() { write(values); });
+    double reads = Measure([&]() { read(data, values.size()); });
+
+    double megabytes = static_cast<double>(data.size()) / (1024.0 * 1024.0);
+    std::printf("%8s %12zu %14.1f %14.1f %16.0f %16.0f\n", format, data.size(),
+                writes * megabytes, reads * megabytes,
+                writes * values.size(), reads * values.size());
+}
+
+
+int main(int argc, char** argv)
+{
+    size_t count = DefaultValueCount;
+    if (argc > 1)
+    {
+        count = static_cast<size_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+
+    std::vector<std::any> values = Values(count);
+
+    std::printf("%zu values\n", count);
+    std::printf("%8s %12s %14s %14s %16s %16s\n", "format", "bytes",
+                "write MiB/s", "read MiB/s", "writes/s", "reads/s");
+
+    Report("json", values, WriteJson, ReadJson);
+    Report("binary", values, WriteBinary, ReadBinary);
+
+    return 0;
+}
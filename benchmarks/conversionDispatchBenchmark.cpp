@@ -0,0 +1,87 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+
+using Clock = std::chrono::steady_clock;
+
+
+static constexpr auto Duration = std::chrono::milliseconds(500);
+
+
+// Converts until Duration elapsed, returns conversions per second.
+template<class F>
+static double Measure(F&& convert)
+{
+    size_t count = 0;
+
+    auto start = Clock::now();
+    std::chrono::duration<double> elapsed{};
+    do
+    {
+        // Checks the clock every 1024 conversions.
+        for (size_t i = 0; i < 1024; i++)
+        {
+            if (!convert().has_value())
+            {
+                std::abort();
+            }
+        }
+
+        count += 1024;
+        elapsed = Clock::now() - start;
+    } while (elapsed < Duration);
+
+    return static_cast<double>(count) / elapsed.count();
+}
+
+
+// Conversion of source to the handler type, through the matrix slot
+// ConvertFrom reads and through converter lookups as ConvertFrom did
+// before: CanConvertFrom then GetConverter, each a hash lookup
+// copying the std::function.
+template<class To, class From>
+static void Report(const char* name, From from)
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<To>();
+
+    std::any source = std::make_any<From>(from);
+    std::any current = handler->InitValue();
+
+    double lookup = Measure([&]()
+    {
+        if (!handler->GetConverter(source))
+        {
+            return std::any();
+        }
+
+        TSys::Converter converter = handler->GetConverter(source);
+        return converter(source, current);
+    });
+
+    double matrix = Measure([&]() { return handler->ConvertFrom(source, current); });
+
+    std::printf("%18s %16.0f %16.0f %10.2f\n", name, lookup, matrix, matrix / lookup);
+}
+
+
+int main()
+{
+    // Resolves registry and ids before timing.
+    TSys::TypeIdOf<int>();
+
+    std::printf("%18s %16s %16s %10s\n", "conversion", "lookup/s", "matrix/s", "speedup");
+
+    Report<int>("float -> int", 2.5f);
+    Report<double>("int -> double", 7);
+    Report<bool>("double -> bool", 0.5);
+    Report<float>("bool -> float", true);
+    Report<int>("string -> int", std::string("42"));
+    Report<TSys::Enum>("int -> Enum", 1);
+
+    return 0;
+}
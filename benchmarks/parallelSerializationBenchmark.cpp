@@ -0,0 +1,122 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+#include "include/parallel.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using Clock = std::chrono::steady_clock;
+
+
+static constexpr auto Duration = std::chrono::milliseconds(500);
+
+static constexpr size_t DefaultValueCount = 100000;
+
+
+// Values of the default types, as a scene of mixed parameters.
+static std::vector<TSys::HandlerValue> Values(size_t count)
+{
+    auto registry = TSys::TypeRegistry::GetRegistry();
+
+    TSys::Enum en(std::vector<std::string>{"linear", "smooth", "step", "constant"}, 2);
+
+    std::vector<TSys::HandlerValue> values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        switch (i % 5)
+        {
+            case 0:
+                values.emplace_back(registry->GetTypeHandle<int>(), std::make_any<int>((int)i));
+                break;
+
+            case 1:
+                values.emplace_back(registry->GetTypeHandle<double>(), std::make_any<double>(i * 0.25));
+                break;
+
+            case 2:
+                values.emplace_back(registry->GetTypeHandle<bool>(), std::make_any<bool>(i % 2 == 0));
+                break;
+
+            case 3:
+                values.emplace_back(registry->GetTypeHandle<std::string>(),
+                                    std::make_any<std::string>("parameter " + std::to_string(i)));
+                break;
+
+            default:
+                values.emplace_back(registry->GetTypeHandle<TSys::Enum>(), std::make_any<TSys::Enum>(en));
+                break;
+        }
+    }
+
+    return values;
+}
+
+
+// Serializes values until Duration elapsed, returns runs per second.
+static double Measure(const std::vector<TSys::HandlerValue>& values, unsigned int threads)
+{
+    size_t runs = 0;
+
+    auto start = Clock::now();
+    std::chrono::duration<double> elapsed{};
+    do
+    {
+        if (TSys::SerializeValues(values, threads).empty())
+        {
+            std::abort();
+        }
+
+        runs++;
+        elapsed = Clock::now() - start;
+    } while (elapsed < Duration);
+
+    return static_cast<double>(runs) / elapsed.count();
+}
+
+
+int main(int argc, char** argv)
+{
+    size_t count = DefaultValueCount;
+    if (argc > 1)
+    {
+        count = static_cast<size_t>(std::strtoul(argv[1], nullptr, 10));
+    }
+
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    if (argc > 2)
+    {
+        maxThreads = static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10));
+    }
+
+    if (!maxThreads)
+    {
+        maxThreads = 1;
+    }
+
+    std::vector<TSys::HandlerValue> values = Values(count);
+    double megabytes = static_cast<double>(TSys::SerializeValues(values, 1).size()) / (1024.0 * 1024.0);
+
+    std::printf("%zu values, %.2f MiB\n", count, megabytes);
+    std::printf("%8s %16s %14s %10s\n", "threads", "values/s", "MiB/s", "speedup");
+
+    double single = 0.0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        double runs = Measure(values, threads);
+        if (threads == 1)
+        {
+            single = runs;
+        }
+
+        std::printf("%8u %16.0f %14.1f %10.2f\n", threads,
+                    runs * count, runs * megabytes, runs / single);
+    }
+
+    return 0;
+}
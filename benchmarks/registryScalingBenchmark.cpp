@@ -0,0 +1,111 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+
+using Clock = std::chrono::steady_clock;
+
+
+static constexpr auto Duration = std::chrono::milliseconds(500);
+
+
+// Handler and id lookups, the registry read path.
+static size_t Lookup(const std::atomic<bool>& stop)
+{
+    auto registry = TSys::TypeRegistry::GetRegistry();
+
+    size_t count = 0;
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        TSys::TypeHandlerPtr handler = registry->GetTypeHandle<int>();
+        TSys::TypeId id = registry->GetTypeId(std::type_index(typeid(float)));
+        if (!handler || id == TSys::InvalidTypeId)
+        {
+            std::abort();
+        }
+
+        count++;
+    }
+
+    return count;
+}
+
+
+// Single value conversions through the conversion matrix.
+static size_t Convert(const std::atomic<bool>& stop)
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<int>();
+    std::any source = std::make_any<float>(2.5f);
+    std::any current = handler->InitValue();
+
+    size_t count = 0;
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        current = handler->ConvertFrom(source, current);
+        count++;
+    }
+
+    return count;
+}
+
+
+// Runs function on threadCount threads and returns operations per second.
+static double Measure(size_t (*function)(const std::atomic<bool>&), unsigned threadCount)
+{
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> total{0};
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back([&]()
+        {
+            total.fetch_add(function(stop), std::memory_order_relaxed);
+        });
+    }
+
+    auto start = Clock::now();
+    std::this_thread::sleep_for(Duration);
+    stop.store(true, std::memory_order_relaxed);
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    return static_cast<double>(total.load()) / elapsed.count();
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    if (argc > 1)
+    {
+        maxThreads = static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10));
+    }
+
+    if (!maxThreads)
+    {
+        maxThreads = 1;
+    }
+
+    // Resolves registry and ids before timing.
+    TSys::TypeIdOf<int>();
+
+    std::printf("%8s %16s %16s\n", "threads", "lookups/s", "conversions/s");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        std::printf("%8u %16.0f %16.0f\n", threads,
+                    Measure(Lookup, threads), Measure(Convert, threads));
+    }
+
+    return 0;
+}
@@ -0,0 +1,228 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+
+#include <any>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+
+using Clock = std::chrono::steady_clock;
+
+
+static constexpr auto Duration = std::chrono::milliseconds(300);
+
+// Values operated on per timed batch.
+static constexpr size_t BatchSize = 1024;
+
+
+// Heap bytes requested through the global operator new.
+static std::atomic<size_t> allocatedBytes{0};
+
+
+void* operator new(std::size_t size)
+{
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void* p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+
+// Heap bytes allocated by build, once its result exists.
+template<class F>
+static size_t HeapBytes(F&& build)
+{
+    size_t before = allocatedBytes.load(std::memory_order_relaxed);
+    auto result = build();
+
+    return allocatedBytes.load(std::memory_order_relaxed) - before;
+}
+
+
+// Runs batch until Duration elapsed, returns nanoseconds per value.
+template<class F>
+static double Measure(F&& batch)
+{
+    size_t count = 0;
+
+    auto start = Clock::now();
+    std::chrono::duration<double> elapsed{};
+    do
+    {
+        batch();
+        count += BatchSize;
+        elapsed = Clock::now() - start;
+    } while (elapsed < Duration);
+
+    return elapsed.count() * 1e9 / static_cast<double>(count);
+}
+
+
+struct Latency
+{
+    double emplace;
+    double copy;
+    double move;
+    double get;
+};
+
+
+static Latency MeasureAny(const std::any& source)
+{
+    std::vector<std::any> values(BatchSize);
+    std::vector<std::any> copies(BatchSize);
+    std::vector<std::any> moved(BatchSize);
+
+    Latency latency{};
+    latency.emplace = Measure([&]()
+    {
+        for (auto& value : values)
+        {
+            value = source;
+        }
+    });
+
+    latency.copy = Measure([&]()
+    {
+        for (size_t i = 0; i < BatchSize; i++)
+        {
+            copies[i] = values[i];
+        }
+    });
+
+    // Two moves per value, back and forth.
+    latency.move = Measure([&]()
+    {
+        for (size_t i = 0; i < BatchSize; i++)
+        {
+            moved[i] = std::move(copies[i]);
+            copies[i] = std::move(moved[i]);
+        }
+    }) / 2.0;
+
+    const std::type_info& type = source.type();
+    size_t found = 0;
+    latency.get = Measure([&]()
+    {
+        for (const auto& value : values)
+        {
+            found += value.type() == type;
+        }
+    });
+
+    if (!found)
+    {
+        std::abort();
+    }
+
+    return latency;
+}
+
+
+static Latency MeasureValue(const TSys::Value& source)
+{
+    std::vector<TSys::Value> values(BatchSize);
+    std::vector<TSys::Value> copies(BatchSize);
+    std::vector<TSys::Value> moved(BatchSize);
+
+    Latency latency{};
+    latency.emplace = Measure([&]()
+    {
+        for (auto& value : values)
+        {
+            value = source;
+        }
+    });
+
+    latency.copy = Measure([&]()
+    {
+        for (size_t i = 0; i < BatchSize; i++)
+        {
+            copies[i] = values[i];
+        }
+    });
+
+    latency.move = Measure([&]()
+    {
+        for (size_t i = 0; i < BatchSize; i++)
+        {
+            moved[i] = std::move(copies[i]);
+            copies[i] = std::move(moved[i]);
+        }
+    }) / 2.0;
+
+    TSys::TypeId id = source.Id();
+    size_t found = 0;
+    latency.get = Measure([&]()
+    {
+        for (const auto& value : values)
+        {
+            found += value.Id() == id;
+        }
+    });
+
+    if (!found)
+    {
+        std::abort();
+    }
+
+    return latency;
+}
+
+
+template<class T>
+static void Report(const char* name, const T& source)
+{
+    size_t anyBytes = HeapBytes([&]() { return std::make_any<T>(source); });
+    size_t valueBytes = HeapBytes([&]() { return TSys::Value(source); });
+
+    Latency any = MeasureAny(std::make_any<T>(source));
+    Latency value = MeasureValue(TSys::Value(source));
+
+    std::printf("%14s %8zu %8zu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", name,
+                sizeof(std::any) + anyBytes, sizeof(TSys::Value) + valueBytes,
+                any.emplace, value.emplace, any.copy, value.copy,
+                any.move, value.move, any.get, value.get);
+}
+
+
+int main()
+{
+    // Resolves registry and ids before timing.
+    TSys::TypeIdOf<int>();
+
+    std::printf("bytes per value, inline and heap, then nanoseconds per value\n");
+    std::printf("%14s %8s %8s %10s %10s %10s %10s %10s %10s %10s %10s\n", "type",
+                "any B", "Value B", "any set", "Value set", "any copy", "Value copy",
+                "any move", "Value move", "any type", "Value id");
+
+    Report("int", 42);
+    Report("double", 0.5);
+    Report("short string", std::string("short"));
+    Report("long string", std::string("a string longer than the small string buffer"));
+    Report("Enum", TSys::Enum(std::vector<std::string>{"linear", "smooth", "step"}, 1));
+    Report("AnyValue", TSys::AnyValue(2.5f));
+
+    return 0;
+}
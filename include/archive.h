@@ -0,0 +1,197 @@
+#pragma once
+
+#include <any>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+#include "tsys.h"
+#include "defaultTypes.h"
+
+#include "api.h"
+
+
+namespace TSys
+{
+    /**
+     * Read-only memory mapping of a whole file.
+     */
+    class TSYS_API MappedFile
+    {
+    protected:
+        const char* data = nullptr;
+        size_t size = 0;
+
+    public:
+        MappedFile() = default;
+
+        MappedFile(const MappedFile&) = delete;
+
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile();
+
+        /**
+         * Maps file, previous mapping is released.
+         * @param const std::string& path: file path.
+         * @return bool success.
+         */
+        bool Open(const std::string& path);
+
+        /**
+         * Releases mapping.
+         */
+        void Close();
+
+        /**
+         * Returns mapped bytes.
+         * @return const char* data, nullptr if nothing is mapped.
+         */
+        const char* Data() const;
+
+        /**
+         * Returns mapped size.
+         * @return size_t size.
+         */
+        size_t Size() const;
+    };
+
+
+    /**
+     * Builds a read-only archive of named values.
+     * Each entry stores its handler name, construction and value as
+     * binary tokens, type names and enum definitions are shared in
+     * tables written with the key index at the end of the archive.
+     */
+    class TSYS_API ArchiveWriter
+    {
+    protected:
+        std::string body;
+
+        // Key to entry offset and size in body, sorted for the index.
+        std::map<std::string, std::pair<uint64_t, uint64_t>> entries;
+
+        std::unordered_map<std::string, uint32_t> typeIds;
+        std::vector<std::string> typeNames;
+
+        EnumSchemaTable enumTable;
+
+    public:
+        ArchiveWriter();
+
+        /**
+         * Adds value, adding an existing key replaces its value.
+         * @param const std::string& key: entry key.
+         * @param const std::any& value: value, its type must be registered.
+         * @return bool success.
+         */
+        bool Add(const std::string& key, const std::any& value);
+
+        /**
+         * Returns archive bytes.
+         * @return std::string archive.
+         */
+        std::string Data() const;
+
+        /**
+         * Writes archive to file.
+         * @param const std::string& path: file path.
+         * @return bool success.
+         */
+        bool Save(const std::string& path) const;
+    };
+
+
+    /**
+     * Memory mapped archive reader.
+     * Opening only checks the archive footer and reads the type and
+     * enum tables, keys are looked up in place in the sorted index and
+     * values are decoded from the mapping when they are requested.
+     * Enums read from the archive share the definitions of its table.
+     */
+    class TSYS_API ArchiveReader
+    {
+    protected:
+        MappedFile file;
+
+        const char* data = nullptr;
+        size_t size = 0;
+
+        const char* index = nullptr;
+        size_t count = 0;
+
+        std::vector<std::string_view> typeNames;
+
+        // Only read once loaded, mutable to be used by const readers
+        // through an EnumSchemaScope.
+        mutable EnumSchemaTable enumTable;
+
+        bool Load();
+
+        bool Find(std::string_view key, std::string_view& entry) const;
+
+    public:
+        ArchiveReader() = default;
+
+        /**
+         * Opens archive file.
+         * @param const std::string& path: file path.
+         * @return bool success.
+         */
+        bool Open(const std::string& path);
+
+        /**
+         * Opens archive from memory, data must outlive the reader.
+         * @param const char* d: archive bytes.
+         * @param size_t s: archive size.
+         * @return bool success.
+         */
+        bool Open(const char* d, size_t s);
+
+        /**
+         * Returns number of entries.
+         * @return size_t count.
+         */
+        size_t Size() const;
+
+        /**
+         * Returns key at index, keys are sorted.
+         * @param size_t i: index.
+         * @return std::string_view key, referencing the mapping.
+         */
+        std::string_view Key(size_t i) const;
+
+        /**
+         * Returns whether archive contains key.
+         * @param std::string_view key: entry key.
+         * @return bool contains.
+         */
+        bool Contains(std::string_view key) const;
+
+        /**
+         * Returns api name of the entry value type.
+         * @param std::string_view key: entry key.
+         * @return std::string_view type name, empty if key is not found.
+         */
+        std::string_view TypeName(std::string_view key) const;
+
+        /**
+         * Returns string value without copy.
+         * @param std::string_view key: entry key.
+         * @param std::string_view& value: result, referencing the mapping.
+         * @return bool success, false if key is not found or not a string.
+         */
+        bool StringView(std::string_view key, std::string_view& value) const;
+
+        /**
+         * Materializes entry value.
+         * @param std::string_view key: entry key.
+         * @return std::any value, empty if key is not found or invalid.
+         */
+        std::any Value(std::string_view key) const;
+    };
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <memory_resource>
+#include <memory>
+#include <cstddef>
+#include <any>
+
+#include "rapidjson/document.h"
+
+#include "api.h"
+#include "tsys.h"
+
+
+namespace TSys
+{
+    /**
+     * Memory arena used while loading documents.
+     * The document, its values and strings are placed in blocks taken
+     * from a std::pmr::memory_resource, so that everything built
+     * while deserializing is released at once with the arena
+     * instead of node by node. Values deserialized through the arena
+     * may own storage taken from it, they must be destroyed before
+     * the arena is released.
+     * The rapidjson::Document type fixes the C heap as the base of its
+     * pool: values that outgrow the first block, sized from the json
+     * length, and the parse stack, freed once parsed, come from malloc.
+     */
+    class TSYS_API DeserializationArena
+    {
+    protected:
+        std::pmr::monotonic_buffer_resource resource;
+
+        // Given to rapidjson, which would otherwise allocate its own
+        // with operator new.
+        rapidjson::CrtAllocator crtAllocator;
+
+        // Both placed in resource.
+        rapidjson::MemoryPoolAllocator<>* allocator = nullptr;
+        rapidjson::Document* document = nullptr;
+
+        void CreateDocument(size_t length);
+
+    public:
+        /**
+         * Constructor.
+         * @param std::pmr::memory_resource* upstream: resource arena
+         * blocks are taken from, a pool or a global buffer for example.
+         */
+        explicit DeserializationArena(
+                std::pmr::memory_resource* upstream=std::pmr::get_default_resource()
+        );
+
+        DeserializationArena(const DeserializationArena&) = delete;
+
+        DeserializationArena& operator=(const DeserializationArena&) = delete;
+
+        ~DeserializationArena();
+
+        /**
+         * Parses json into a document living in the arena, previous
+         * document is released.
+         * @param const char* json: json string.
+         * @param size_t length: json string length.
+         * @return rapidjson::Document& parsed document.
+         */
+        rapidjson::Document& Parse(const char* json, size_t length);
+
+        /**
+         * Parses json in place, document strings reference the parsed
+         * text instead of being copied one by one. Json is copied once
+         * into the arena, which keeps it alive until released.
+         * @param const char* json: json string.
+         * @param size_t length: json string length.
+         * @return rapidjson::Document& parsed document.
+         */
+        rapidjson::Document& ParseInsitu(const char* json, size_t length);
+
+        /**
+         * Parses caller buffer in place, without any copy.
+         * Buffer is modified and must outlive the document.
+         * @param char* json: null terminated json string.
+         * @param size_t length: json string length.
+         * @return rapidjson::Document& parsed document.
+         */
+        rapidjson::Document& ParseInsitu(char* json, size_t length);
+
+        /**
+         * Returns last parsed document.
+         * @return rapidjson::Document* document, nullptr if nothing was parsed.
+         */
+        rapidjson::Document* Document() const;
+
+        /**
+         * Returns arena memory resource, for callers that store their
+         * own deserialized data in pmr containers.
+         * @return std::pmr::memory_resource* resource.
+         */
+        std::pmr::memory_resource* Resource();
+
+        /**
+         * Deserializes value, storage it owns is taken from the arena
+         * where handler supports it.
+         * @param const TypeHandler& handler: value handler.
+         * @param std::any v: current value.
+         * @param rapidjson::Value& value: json value.
+         * @return std::any deserialized value.
+         */
+        std::any DeserializeValue(const TypeHandler& handler, const std::any& v,
+                                  rapidjson::Value& value);
+
+        /**
+         * Deserializes construction, storage it owns is taken from the
+         * arena where handler supports it.
+         * @param const TypeHandler& handler: value handler.
+         * @param rapidjson::Value& value: json value.
+         * @return std::any built value.
+         */
+        std::any DeserializeConstruction(const TypeHandler& handler, rapidjson::Value& value);
+
+        /**
+         * Releases every block at once.
+         */
+        void Release();
+    };
+}
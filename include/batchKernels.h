@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+
+#include "api.h"
+
+
+namespace TSys
+{
+    /**
+     * Converts contiguous values with static_cast semantics.
+     * Used by batch converters, numeric pairs are specialized
+     * with vectorized implementations.
+     */
+    template<typename From, typename To>
+    struct BatchKernel
+    {
+        static void Run(const From* sources, To* results, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                results[i] = static_cast<To>(sources[i]);
+            }
+        }
+    };
+
+
+    enum class SimdLevel
+    {
+        Scalar,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+
+    /**
+     * Returns best instruction set supported by both cpu and os,
+     * detected once.
+     * @return SimdLevel level.
+     */
+    TSYS_API SimdLevel DetectedSimdLevel();
+
+
+    // Vectorized kernels, dispatched at runtime between SSE2, AVX2
+    // and AVX-512 implementations, with a scalar fallback. Results
+    // are bit-exact with the scalar static_cast. RunAt forces a level,
+    // falling back like dispatch does, and returns false without
+    // converting if the cpu does not support that level.
+#define TSYS_DECLARE_BATCH_KERNEL(From, To)                                 \
+    template<>                                                              \
+    struct TSYS_API BatchKernel<From, To>                                   \
+    {                                                                       \
+        static void Run(const From* sources, To* results, size_t count);    \
+                                                                            \
+        static bool RunAt(SimdLevel level, const From* sources,             \
+                          To* results, size_t count);                       \
+    };
+
+    TSYS_DECLARE_BATCH_KERNEL(int, float)
+    TSYS_DECLARE_BATCH_KERNEL(int, double)
+    TSYS_DECLARE_BATCH_KERNEL(int, bool)
+    TSYS_DECLARE_BATCH_KERNEL(float, int)
+    TSYS_DECLARE_BATCH_KERNEL(float, double)
+    TSYS_DECLARE_BATCH_KERNEL(float, bool)
+    TSYS_DECLARE_BATCH_KERNEL(double, int)
+    TSYS_DECLARE_BATCH_KERNEL(double, float)
+    TSYS_DECLARE_BATCH_KERNEL(double, bool)
+    TSYS_DECLARE_BATCH_KERNEL(bool, int)
+    TSYS_DECLARE_BATCH_KERNEL(bool, float)
+    TSYS_DECLARE_BATCH_KERNEL(bool, double)
+
+#undef TSYS_DECLARE_BATCH_KERNEL
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+#include "tsys.h"
+
+#include "api.h"
+
+
+namespace TSys
+{
+    /**
+     * Compact binary codec for handler values, an alternative to json.
+     * Each token is a one byte tag followed by its payload: scalars
+     * are raw little-endian values, strings are a varint length and
+     * bytes. Type names are stored in a per-document table, the first
+     * occurrence of a name defines the next id and later ones only
+     * write that id.
+     * Handlers do not need anything specific, BinaryWriter and
+     * BinaryReader implement JsonWriter and JsonReader, so that
+     * WriteValue / ReadValue produce the same values as the json path.
+     */
+    namespace Binary
+    {
+        // Document header, magic then format version.
+        static constexpr char Magic[4] = {'T', 'S', 'Y', 'B'};
+        static constexpr uint8_t Version = 1;
+
+        enum class Tag: uint8_t
+        {
+            Null,
+            False,
+            True,
+            Int,
+            Uint,
+            Int64,
+            Uint64,
+            Double,
+            String,
+            RawNumber,
+            Key,
+            StartObject,
+            EndObject,
+            StartArray,
+            EndArray,
+            TypeDefinition,
+            TypeReference
+        };
+    }
+
+
+    /**
+     * JsonWriter appending binary tokens to a string buffer.
+     */
+    class TSYS_API BinaryWriter: public JsonWriter
+    {
+    protected:
+        std::string& output;
+
+        std::unordered_map<std::string, uint32_t> typeIds;
+
+        void Put(Binary::Tag tag);
+
+        void PutVarint(uint64_t v);
+
+        void PutFixed(uint64_t v, size_t size);
+
+        void PutBytes(const Ch* str, size_t length);
+
+        /**
+         * Constructor.
+         * @param std::string& out: output buffer, appended to.
+         * @param bool header: whether to write document header, false
+         * for tokens embedded in another container.
+         */
+        BinaryWriter(std::string& out, bool header);
+
+    public:
+        /**
+         * Constructor, writes document header.
+         * @param std::string& out: output buffer, appended to.
+         */
+        explicit BinaryWriter(std::string& out);
+
+        bool Null() override;
+        bool Bool(bool b) override;
+        bool Int(int i) override;
+        bool Uint(unsigned u) override;
+        bool Int64(int64_t i) override;
+        bool Uint64(uint64_t u) override;
+        bool Double(double d) override;
+        bool RawNumber(const Ch* str, rapidjson::SizeType length, bool copy) override;
+        bool String(const Ch* str, rapidjson::SizeType length, bool copy) override;
+        bool StartObject() override;
+        bool Key(const Ch* str, rapidjson::SizeType length, bool copy) override;
+        bool EndObject(rapidjson::SizeType memberCount) override;
+        bool StartArray() override;
+        bool EndArray(rapidjson::SizeType elementCount) override;
+
+        bool TypeName(const std::string& name) override;
+
+        using JsonWriter::String;
+    };
+
+
+    /**
+     * JsonReader decoding binary tokens from a memory range, type
+     * names are returned as string tokens.
+     * Strings reference the range without copy, it must outlive the
+     * reader.
+     */
+    class TSYS_API BinaryReader: public JsonReader
+    {
+    protected:
+        const char* cursor;
+        const char* end;
+
+        bool headerRead = false;
+
+        std::vector<std::string_view> typeNames;
+
+        bool Read() override;
+
+        bool GetVarint(uint64_t& v);
+
+        bool GetFixed(uint64_t& v, size_t size);
+
+        bool GetBytes(std::string_view& bytes);
+
+    public:
+        /**
+         * Constructor.
+         * @param const char* data: binary document.
+         * @param size_t size: document size.
+         */
+        BinaryReader(const char* data, size_t size);
+
+        /**
+         * Constructor.
+         * @param std::string_view data: binary document.
+         */
+        explicit BinaryReader(std::string_view data);
+    };
+}
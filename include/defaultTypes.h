@@ -9,6 +9,12 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <list>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <unordered_map>
+#include <cstdint>
 #include "rapidjson/reader.h"
 #include "rapidjson/document.h"
 
@@ -42,17 +48,124 @@ namespace TSys
 
 
     // Declare types
+    /**
+     * Immutable enum definition, flat table of (index, name) sorted by
+     * index, shared by every Enum using it.
+     * Names are indexed by hash and the definition hash is computed
+     * once, so that lookups, comparisons and hashing do not allocate.
+     */
+    class TSYS_API EnumDefinition
+    {
+    public:
+        typedef std::pair<unsigned int, std::pmr::string> Entry;
+
+    protected:
+        // Entries and index live in the resource of the entries given
+        // on construction, copies use the default resource.
+        std::pmr::vector<Entry> values;
+
+        // Views on values names.
+        std::pmr::unordered_map<std::string_view, unsigned int> names;
+
+        size_t hash = 0;
+
+        // Indices are 0 to Size() - 1, the index is the position.
+        bool dense = false;
+
+        void BuildIndex();
+
+    public:
+        EnumDefinition();
+
+        EnumDefinition(const EnumDefinition& other);
+
+        EnumDefinition& operator=(const EnumDefinition& other);
+
+        /**
+         * Constructor.
+         * @param std::pmr::vector<Entry> v: entries, sorted by constructor,
+         * last entry wins for duplicated indices. Definition storage
+         * is taken from the resource of v.
+         */
+        explicit EnumDefinition(std::pmr::vector<Entry> v);
+
+        explicit EnumDefinition(const std::map<unsigned int, std::string>& v);
+
+        explicit EnumDefinition(const std::vector<std::string>& v);
+
+        /**
+         * Returns entries, sorted by index.
+         * @return const std::pmr::vector<Entry>& entries.
+         */
+        const std::pmr::vector<Entry>& Values() const;
+
+        /**
+         * Returns number of entries.
+         * @return size_t size.
+         */
+        size_t Size() const;
+
+        /**
+         * Finds entry by index.
+         * @param unsigned int index: index.
+         * @return const Entry* entry, nullptr if not found.
+         */
+        const Entry* Find(unsigned int index) const;
+
+        /**
+         * Finds entry by name, first one for duplicated names.
+         * @param std::string_view name: name.
+         * @return const Entry* entry, nullptr if not found.
+         */
+        const Entry* Find(std::string_view name) const;
+
+        /**
+         * Returns position of entry in Values(), constant time for
+         * definitions indexed 0 to Size() - 1.
+         * @param unsigned int index: index.
+         * @return size_t position, Size() if not found.
+         */
+        size_t Position(unsigned int index) const;
+
+        /**
+         * Returns hash of every entry, computed on construction.
+         * @return size_t hash.
+         */
+        size_t Hash() const;
+
+        bool operator ==(const EnumDefinition& other) const;
+
+        bool operator <(const EnumDefinition& other) const;
+    };
+
+
+    typedef std::shared_ptr<const EnumDefinition> EnumDefinitionPtr;
+
+
     class TSYS_API Enum
     {
     protected:
-        std::map<unsigned int, std::string> values;
+        // Never null, enums without values share an empty definition.
+        EnumDefinitionPtr definition;
         unsigned int currentIndex;
 
     public:
         Enum();
 
 
-        Enum(const Enum& other);
+        Enum(const Enum& other) = default;
+
+
+        Enum(Enum&& other) noexcept = default;
+
+
+        Enum& operator=(const Enum& other) = default;
+
+
+        Enum& operator=(Enum&& other) noexcept = default;
+
+
+        Enum(EnumDefinitionPtr d, unsigned int i=0);
 
 
         Enum(const std::map<unsigned int, std::string>& v);
@@ -79,13 +192,20 @@ namespace TSys
         bool SetCurrentValue(std::string value);
 
 
+        /**
+         * Adds value, definition being shared it is copied first.
+         * Prefer building an EnumDefinition to add many values.
+         */
         void AddValue(int index, std::string value);
 
 
-        std::vector<int> Indices();
+        std::vector<int> Indices() const;
+
+
+        std::string ValueAtIndex(int index) const;
 
 
-        std::string ValueAtIndex(int index);
+        const EnumDefinitionPtr& Definition() const;
 
 
         bool operator ==(const Enum& other) const;
@@ -95,6 +215,278 @@ namespace TSys
     };
 
 
+    /**
+     * Set of values of an enum definition, one bit per entry in
+     * definition order.
+     * Definitions of up to 64 entries fit in an inline word, bits of
+     * larger ones spill to heap words, so that union, intersection and
+     * tests are word operations.
+     */
+    class TSYS_API EnumFlags
+    {
+    public:
+        static constexpr size_t WordBits = 64;
+
+    protected:
+        // Never null, flags without values share an empty definition.
+        EnumDefinitionPtr definition;
+
+        // Entries 0 to 63, then one word per 64 entries.
+        uint64_t bits = 0;
+        std::vector<uint64_t> words;
+
+        uint64_t& WordAt(size_t word);
+
+        // Clears bits past the last entry.
+        void Trim();
+
+        // Flags of other laid out on this definition: other itself for
+        // equal definitions, else matched by name into storage.
+        const EnumFlags& Aligned(const EnumFlags& other, EnumFlags& storage) const;
+
+    public:
+        EnumFlags();
+
+        explicit EnumFlags(EnumDefinitionPtr d);
+
+        /**
+         * Constructor, flags on enum definition with current value set.
+         * @param const Enum& en: enum.
+         */
+        explicit EnumFlags(const Enum& en);
+
+        explicit EnumFlags(const std::vector<std::string>& v);
+
+        const EnumDefinitionPtr& Definition() const;
+
+        /**
+         * Returns number of entries, that is of bits.
+         * @return size_t size.
+         */
+        size_t Size() const;
+
+        /**
+         * Returns number of words holding bits.
+         * @return size_t word count.
+         */
+        size_t WordCount() const;
+
+        /**
+         * Returns word of bits, bit i of word w is entry w * 64 + i.
+         * @param size_t word: word, lower than WordCount().
+         * @return uint64_t bits.
+         */
+        uint64_t Word(size_t word) const;
+
+        /**
+         * Sets word of bits, bits past the last entry are ignored.
+         * @param size_t word: word, lower than WordCount().
+         * @param uint64_t value: bits.
+         */
+        void SetWord(size_t word, uint64_t value);
+
+        /**
+         * Sets or resets value by enum index.
+         * @param unsigned int index: enum index.
+         * @param bool value: set.
+         * @return bool success, false if index is not in definition.
+         */
+        bool Set(unsigned int index, bool value=true);
+
+        bool Reset(unsigned int index);
+
+        bool Test(unsigned int index) const;
+
+        /**
+         * Sets or resets value by name.
+         * @param std::string_view name: value name.
+         * @param bool value: set.
+         * @return bool success, false if name is not in definition.
+         */
+        bool SetValue(std::string_view name, bool value=true);
+
+        bool TestValue(std::string_view name) const;
+
+        bool SetPosition(size_t position, bool value=true);
+
+        bool TestPosition(size_t position) const;
+
+        /**
+         * Resets every value.
+         */
+        void Clear();
+
+        /**
+         * Returns number of set values.
+         * @return size_t count.
+         */
+        size_t Count() const;
+
+        bool Any() const;
+
+        bool None() const;
+
+        /**
+         * Returns set indices, in definition order.
+         * @return std::vector<unsigned int> indices.
+         */
+        std::vector<unsigned int> Indices() const;
+
+        /**
+         * Returns set value names, in definition order.
+         * @return std::vector<std::string> names.
+         */
+        std::vector<std::string> Values() const;
+
+        size_t Hash() const;
+
+        // Flags without entries take the definition of other.
+        EnumFlags& operator |=(const EnumFlags& other);
+
+        EnumFlags& operator &=(const EnumFlags& other);
+
+        EnumFlags& operator ^=(const EnumFlags& other);
+
+        EnumFlags operator |(const EnumFlags& other) const;
+
+        EnumFlags operator &(const EnumFlags& other) const;
+
+        EnumFlags operator ^(const EnumFlags& other) const;
+
+        bool operator ==(const EnumFlags& other) const;
+
+        bool operator !=(const EnumFlags& other) const;
+    };
+
+
+    /**
+     * Document level table of Enum definitions.
+     * While a table is in use on the current thread (see EnumSchemaScope),
+     * Enum constructions are serialized as the id of their definition
+     * in the table instead of the full index / value list, so that a
+     * definition shared by many values is written and parsed once.
+     * The table is saved with Serialize, and must be loaded with
+     * Deserialize before the values referencing it are read.
+     */
+    class TSYS_API EnumSchemaTable
+    {
+    protected:
+        struct DefinitionLess
+        {
+            bool operator()(const EnumDefinition* d1, const EnumDefinition* d2) const
+            {
+                return *d1 < *d2;
+            }
+        };
+
+        // Ids by definition content, and by shared definition so that
+        // enums sharing a definition skip the comparison.
+        std::map<const EnumDefinition*, unsigned int, DefinitionLess> ids;
+        std::unordered_map<const EnumDefinition*, unsigned int> sharedIds;
+
+        // Definitions by id, then other definitions in sharedIds,
+        // kept alive so that their address is not reused.
+        std::vector<EnumDefinitionPtr> definitions;
+        std::vector<EnumDefinitionPtr> aliases;
+
+        unsigned int Insert(const EnumDefinitionPtr& definition);
+
+    public:
+        EnumSchemaTable() = default;
+
+        EnumSchemaTable(const EnumSchemaTable&) = delete;
+
+        EnumSchemaTable& operator=(const EnumSchemaTable&) = delete;
+
+        /**
+         * Adds enum definition, if not already in table.
+         * @param const Enum& en: enum.
+         * @return unsigned int definition id.
+         */
+        unsigned int Add(const Enum& en);
+
+        /**
+         * Adds definition, if not already in table.
+         * @param const EnumDefinitionPtr& definition: definition, not null.
+         * @return unsigned int definition id.
+         */
+        unsigned int Add(const EnumDefinitionPtr& definition);
+
+        /**
+         * Returns definition, shared by every enum read from it.
+         * @param unsigned int id: definition id.
+         * @return EnumDefinitionPtr definition, nullptr if id is unknown.
+         */
+        EnumDefinitionPtr Definition(unsigned int id) const;
+
+        /**
+         * Returns number of definitions.
+         * @return size_t size.
+         */
+        size_t Size() const;
+
+        /**
+         * Removes every definition.
+         */
+        void Clear();
+
+        /**
+         * Serializes table, as an array of [index, value, ...] arrays.
+         * @param rapidjson::Value& value: result value.
+         * @param rapidjson::Document& doc: document.
+         */
+        void Serialize(rapidjson::Value& value, rapidjson::Document& doc) const;
+
+        /**
+         * Loads serialized table, replacing current definitions.
+         * @param const rapidjson::Value& value: serialized table.
+         * @return bool success.
+         */
+        bool Deserialize(const rapidjson::Value& value);
+
+        /**
+         * Streams table, same layout as Serialize.
+         * @param JsonWriter& writer: json writer.
+         */
+        void Write(JsonWriter& writer) const;
+
+        /**
+         * Reads streamed table, replacing current definitions.
+         * @param JsonReader& reader: json reader, on the table StartArray.
+         * @return bool success.
+         */
+        bool Read(JsonReader& reader);
+
+        /**
+         * Returns table in use on current thread.
+         * @return EnumSchemaTable* table, nullptr if none.
+         */
+        static EnumSchemaTable* Current();
+
+        friend class EnumSchemaScope;
+    };
+
+
+    /**
+     * Uses an EnumSchemaTable on the current thread for its lifetime,
+     * previous table is restored on destruction.
+     */
+    class TSYS_API EnumSchemaScope
+    {
+    protected:
+        EnumSchemaTable* previous;
+
+    public:
+        explicit EnumSchemaScope(EnumSchemaTable& table);
+
+        EnumSchemaScope(const EnumSchemaScope&) = delete;
+
+        EnumSchemaScope& operator=(const EnumSchemaScope&) = delete;
+
+        ~EnumSchemaScope();
+    };
+
+
     // Any
     struct TSYS_API InvalidAnyCast
     {
@@ -114,6 +506,31 @@ namespace TSys
     protected:
         std::any value;
 
+        // Registry id of the held value type, kept in sync with value.
+        TypeId id = InvalidTypeId;
+
+        struct Conversion
+        {
+            TypeId id;
+            size_t hash;
+            std::any value;
+        };
+
+        // ConvertTo results for value, cleared whenever value changes.
+        // List nodes keep results returned by ConvertToRef in place
+        // while other conversions are cached.
+        bool cacheConversions = false;
+        std::list<Conversion> conversions;
+
+        // Last ConvertToRef result, while cache is disabled.
+        std::any lastConversion;
+
+        const std::any& CacheConversion(const TypeHandler& handler, std::any converted);
+
+        // Returns value or cached conversion to target type, nullptr
+        // if value has to be converted.
+        const std::any* CachedConversion(TypeId targetId) const;
+
     public:
         explicit AnyValue() = default;
 
@@ -121,6 +538,7 @@ namespace TSys
         explicit AnyValue(T v)
         {
             value = std::make_any<T>(v);
+            id = TypeIdOf<T>();
         }
 
         explicit AnyValue(std::any v);
@@ -140,29 +558,168 @@ namespace TSys
             return std::any_cast<T>(value);
         }
 
+        template<class T>
+        bool Is() const
+        {
+            return id == TypeIdOf<T>();
+        }
+
+        /**
+         * Returns held value without copy.
+         * @return const T* value, nullptr if held type is not T.
+         */
+        template<class T>
+        const T* GetIf() const
+        {
+            return std::any_cast<T>(&value);
+        }
+
+        /**
+         * Returns held value without copy, for read-only access through
+         * a non-const AnyValue, which keeps cached conversions.
+         * @return const T* value, nullptr if held type is not T.
+         */
+        template<class T>
+        const T* CGetIf() const
+        {
+            return std::any_cast<T>(&value);
+        }
+
+        // Value may be modified through result, clears conversions.
+        template<class T>
+        T* GetIf()
+        {
+            ClearConversionCache();
+            return std::any_cast<T>(&value);
+        }
+
+        /**
+         * Returns reference on held value, throws std::bad_any_cast
+         * like Get if held type is not T.
+         * @return const T& value.
+         */
+        template<class T>
+        const T& GetRef() const
+        {
+            return std::any_cast<const T&>(value);
+        }
+
+        /**
+         * Returns reference on held value like the const GetRef, for
+         * read-only access through a non-const AnyValue.
+         * @return const T& value.
+         */
+        template<class T>
+        const T& CGetRef() const
+        {
+            return std::any_cast<const T&>(value);
+        }
+
+        // Value may be modified through result, clears conversions.
+        template<class T>
+        T& GetRef()
+        {
+            ClearConversionCache();
+            return std::any_cast<T&>(value);
+        }
+
+        /**
+         * Calls f with a const reference on held value, for the first of
+         * Ts matching held type, by type id.
+         * Without Ts, default types are tried: std::string, bool, int,
+         * float, double, Enum and EnumFlags.
+         * @param F&& f: callable, taking every type of Ts.
+         * @return bool true if f was called.
+         */
+        template<class... Ts, class F>
+        bool Visit(F&& f) const
+        {
+            if constexpr (sizeof...(Ts) == 0)
+            {
+                return Visit<std::string, bool, int, float, double, Enum, EnumFlags>(
+                        std::forward<F>(f));
+            }
+            else
+            {
+                return (VisitAs<Ts>(f) || ...);
+            }
+        }
+
         template<class T>
         void Set(T newValue)
         {
             value = std::make_any<T>(newValue);
+            id = TypeIdOf<T>();
+            ClearConversionCache();
         }
 
         void SetInput(const std::any& val);
 
         size_t Hash() const;
 
+        TypeId Id() const;
+
         std::string Name() const;
 
+        /**
+         * Returns copy of held value, prefer Input.
+         * @return std::any value.
+         */
         std::any InputValue() const;
 
+        /**
+         * Returns held value without copy.
+         * @return const std::any& value.
+         */
+        const std::any& Input() const;
+
         boost::python::object Python_Get();
 
         bool Python_Set(boost::python::object val);
 
+        /**
+         * Enables caching of ConvertTo results by target type, so that
+         * converting an unchanged value again is a lookup.
+         * Cache is cleared by Set, SetInput, Python_Set and the
+         * non-const GetIf and GetRef. Failed conversions are not cached.
+         * @param bool enable: enable, disabling also clears cache.
+         */
+        void EnableConversionCache(bool enable=true);
+
+        bool ConversionCacheEnabled() const;
+
+        void ClearConversionCache();
+
         std::any ConvertTo(size_t hash);
 
-        bool  operator == (AnyValue& other);
+        std::any ConvertTo(TypeId targetId);
 
-        bool operator == (std::any& other);
+        /**
+         * Converts value to target type like ConvertTo, but returns
+         * value or cached conversions without copying them.
+         * @param TypeId targetId: target type.
+         * @return const std::any& converted value, valid until value
+         * changes or cache is cleared, or with cache disabled until the
+         * next ConvertToRef call.
+         */
+        const std::any& ConvertToRef(TypeId targetId);
+
+        bool operator == (const AnyValue& other) const;
+
+        bool operator == (const std::any& other) const;
+
+    protected:
+        template<class T, class F>
+        bool VisitAs(F& f) const
+        {
+            if (id != TypeIdOf<T>())
+            {
+                return false;
+            }
+
+            f(*std::any_cast<T>(&value));
+            return true;
+        }
     };
 
 
@@ -171,24 +728,147 @@ namespace TSys
         [[nodiscard]]
         std::any operator()(const std::any& from, const std::any& current) const
         {
-            auto anyval = std::any_cast<TSys::AnyValue>(from);
+            const auto& anyval = std::any_cast<const TSys::AnyValue&>(from);
             if (anyval.Hash() == current.type().hash_code())
             {
-                return anyval.InputValue();
+                return anyval.Input();
             }
 
-            auto handle = TypeRegistry::GetRegistry()->GetTypeHandle(current.type().hash_code());
+            TypeRegistry::ReadGuard guard;
+
+            const TypeHandler* handle = TypeRegistry::GetRegistry()->FindTypeHandle(current.type());
             if (!handle)
             {
                 return current;
             }
 
-            if (!handle->CanConvertFrom(anyval.Hash()))
+            if (!handle->CanConvertFrom(anyval.Input()))
             {
                 return current;
             }
 
-            return handle->ConvertFrom(anyval.InputValue(), current);
+            return handle->ConvertFrom(anyval.Input(), current);
+        }
+    };
+
+
+    // Typed handles
+    template<>
+    struct TypedHandle<std::string>: TypedHandleBase<std::string>
+    {
+        static void Serialize(const std::string& v, rapidjson::Value& jsonValue,
+                              rapidjson::Document& doc)
+        {
+            jsonValue.SetString(v.c_str(), (rapidjson::SizeType)v.size(),
+                                doc.GetAllocator());
+        }
+
+
+        static void Serialize(const std::string& v, JsonWriter& writer)
+        {
+            writer.String(v);
+        }
+
+        static std::string Deserialize(const rapidjson::Value& jsonValue)
+        {
+            return {jsonValue.GetString(), jsonValue.GetStringLength()};
+        }
+
+        /**
+         * Borrows json string without copy, valid as long as the json
+         * value, and its buffer when parsed in place.
+         */
+        static std::string_view View(const rapidjson::Value& jsonValue)
+        {
+            return {jsonValue.GetString(), jsonValue.GetStringLength()};
+        }
+    };
+
+
+    template<>
+    struct TypedHandle<bool>: TypedHandleBase<bool>
+    {
+        static void Serialize(const bool& v, rapidjson::Value& jsonValue,
+                              rapidjson::Document&)
+        {
+            jsonValue.SetBool(v);
+        }
+
+
+        static void Serialize(const bool& v, JsonWriter& writer)
+        {
+            writer.Bool(v);
+        }
+
+        static bool Deserialize(const rapidjson::Value& jsonValue)
+        {
+            return jsonValue.GetBool();
+        }
+    };
+
+
+    template<>
+    struct TypedHandle<int>: TypedHandleBase<int>
+    {
+        static void Serialize(const int& v, rapidjson::Value& jsonValue,
+                              rapidjson::Document&)
+        {
+            jsonValue.SetInt(v);
+        }
+
+
+        static void Serialize(const int& v, JsonWriter& writer)
+        {
+            writer.Int(v);
+        }
+
+        static int Deserialize(const rapidjson::Value& jsonValue)
+        {
+            return jsonValue.GetInt();
+        }
+    };
+
+
+    template<>
+    struct TypedHandle<float>: TypedHandleBase<float>
+    {
+        static void Serialize(const float& v, rapidjson::Value& jsonValue,
+                              rapidjson::Document&)
+        {
+            jsonValue.SetFloat(v);
+        }
+
+
+        static void Serialize(const float& v, JsonWriter& writer)
+        {
+            writer.Float(v);
+        }
+
+        static float Deserialize(const rapidjson::Value& jsonValue)
+        {
+            return jsonValue.GetFloat();
+        }
+    };
+
+
+    template<>
+    struct TypedHandle<double>: TypedHandleBase<double>
+    {
+        static void Serialize(const double& v, rapidjson::Value& jsonValue,
+                              rapidjson::Document&)
+        {
+            jsonValue.SetDouble(v);
+        }
+
+
+        static void Serialize(const double& v, JsonWriter& writer)
+        {
+            writer.Double(v);
+        }
+
+        static double Deserialize(const rapidjson::Value& jsonValue)
+        {
+            return jsonValue.GetDouble();
         }
     };
 
@@ -202,8 +882,6 @@ namespace TSys
 
         std::any InitValue() const override;
 
-        std::any CopyValue(const std::any& source) const override;
-
         std::any FromPython(const boost::python::object& obj) const override;
 
         boost::python::object ToPython(const std::any& value) const override;
@@ -218,6 +896,14 @@ namespace TSys
 
         std::any DeserializeConstruction(rapidjson::Value& value) const override;
 
+        void WriteValue(const std::any& v, JsonWriter& writer) const override;
+
+        void WriteConstruction(const std::any& v, JsonWriter& writer) const override;
+
+        std::any ReadValue(const std::any& v, JsonReader& reader) const override;
+
+        std::any ReadConstruction(JsonReader& reader) const override;
+
     };
 
 
@@ -229,8 +915,6 @@ namespace TSys
 
         std::any InitValue() const override;
 
-        std::any CopyValue(const std::any& source) const override;
-
         std::any FromPython(const boost::python::object& obj) const override;
 
         boost::python::object ToPython(const std::any& value) const override;
@@ -245,6 +929,14 @@ namespace TSys
 
         std::any DeserializeConstruction(rapidjson::Value& value) const override;
 
+        void WriteValue(const std::any& v, JsonWriter& writer) const override;
+
+        void WriteConstruction(const std::any& v, JsonWriter& writer) const override;
+
+        std::any ReadValue(const std::any& v, JsonReader& reader) const override;
+
+        std::any ReadConstruction(JsonReader& reader) const override;
+
     };
 
 
@@ -257,12 +949,31 @@ namespace TSys
 
         std::any InitValue() const override;
 
-        std::any CopyValue(const std::any& source) const override;
-
         std::any FromPython(const boost::python::object& obj) const override;
 
         boost::python::object ToPython(const std::any& value) const override;
 
+        /**
+         * Exposes values to python as a read-only memoryview of format
+         * "i", through the buffer protocol and without copy, that
+         * numpy.asarray also wraps without copy.
+         * Values must outlive the returned object.
+         * @param const int* values: contiguous values.
+         * @param size_t count: number of values.
+         * @return boost::python::object memoryview, None on failure.
+         */
+        boost::python::object ToPythonArray(const int* values, size_t count) const;
+
+        /**
+         * Reads a buffer protocol object (numpy array, array.array,
+         * memoryview...) of numeric items, converted to int, in C order.
+         * @param const boost::python::object& obj: object.
+         * @param std::vector<int>& values: result values.
+         * @return bool success, false if obj has no buffer or its items
+         * are not numbers in native byte order.
+         */
+        bool FromPythonArray(const boost::python::object& obj, std::vector<int>& values) const;
+
         void SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
                             rapidjson::Document& doc) const override;
 
@@ -272,6 +983,14 @@ namespace TSys
                                    rapidjson::Document& doc) const override;
 
         std::any DeserializeConstruction(rapidjson::Value& value) const override;
+
+        void WriteValue(const std::any& v, JsonWriter& writer) const override;
+
+        void WriteConstruction(const std::any& v, JsonWriter& writer) const override;
+
+        std::any ReadValue(const std::any& v, JsonReader& reader) const override;
+
+        std::any ReadConstruction(JsonReader& reader) const override;
     };
 
 
@@ -284,12 +1003,31 @@ namespace TSys
 
         std::any InitValue() const override;
 
-        std::any CopyValue(const std::any& source) const override;
-
         std::any FromPython(const boost::python::object& obj) const override;
 
         boost::python::object ToPython(const std::any& value) const override;
 
+        /**
+         * Exposes values to python as a read-only memoryview of format
+         * "f", through the buffer protocol and without copy, that
+         * numpy.asarray also wraps without copy.
+         * Values must outlive the returned object.
+         * @param const float* values: contiguous values.
+         * @param size_t count: number of values.
+         * @return boost::python::object memoryview, None on failure.
+         */
+        boost::python::object ToPythonArray(const float* values, size_t count) const;
+
+        /**
+         * Reads a buffer protocol object (numpy array, array.array,
+         * memoryview...) of numeric items, converted to float, in C order.
+         * @param const boost::python::object& obj: object.
+         * @param std::vector<float>& values: result values.
+         * @return bool success, false if obj has no buffer or its items
+         * are not numbers in native byte order.
+         */
+        bool FromPythonArray(const boost::python::object& obj, std::vector<float>& values) const;
+
         void SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
                             rapidjson::Document& doc) const override;
 
@@ -299,6 +1037,14 @@ namespace TSys
                                    rapidjson::Document& doc) const override;
 
         std::any DeserializeConstruction(rapidjson::Value& value) const override;
+
+        void WriteValue(const std::any& v, JsonWriter& writer) const override;
+
+        void WriteConstruction(const std::any& v, JsonWriter& writer) const override;
+
+        std::any ReadValue(const std::any& v, JsonReader& reader) const override;
+
+        std::any ReadConstruction(JsonReader& reader) const override;
     };
 
 
@@ -311,12 +1057,31 @@ namespace TSys
 
         std::any InitValue() const override;
 
-        std::any CopyValue(const std::any& source) const override;
-
         std::any FromPython(const boost::python::object& obj) const override;
 
         boost::python::object ToPython(const std::any& value) const override;
 
+        /**
+         * Exposes values to python as a read-only memoryview of format
+         * "d", through the buffer protocol and without copy, that
+         * numpy.asarray also wraps without copy.
+         * Values must outlive the returned object.
+         * @param const double* values: contiguous values.
+         * @param size_t count: number of values.
+         * @return boost::python::object memoryview, None on failure.
+         */
+        boost::python::object ToPythonArray(const double* values, size_t count) const;
+
+        /**
+         * Reads a buffer protocol object (numpy array, array.array,
+         * memoryview...) of numeric items, converted to double, in C order.
+         * @param const boost::python::object& obj: object.
+         * @param std::vector<double>& values: result values.
+         * @return bool success, false if obj has no buffer or its items
+         * are not numbers in native byte order.
+         */
+        bool FromPythonArray(const boost::python::object& obj, std::vector<double>& values) const;
+
         void SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
                             rapidjson::Document& doc) const override;
 
@@ -326,6 +1091,14 @@ namespace TSys
                                    rapidjson::Document& doc) const override;
 
         std::any DeserializeConstruction(rapidjson::Value& value) const override;
+
+        void WriteValue(const std::any& v, JsonWriter& writer) const override;
+
+        void WriteConstruction(const std::any& v, JsonWriter& writer) const override;
+
+        std::any ReadValue(const std::any& v, JsonReader& reader) const override;
+
+        std::any ReadConstruction(JsonReader& reader) const override;
     };
 
 
@@ -362,9 +1135,84 @@ namespace TSys
         std::any DeserializeConstruction(rapidjson::Value& value)
                                          const override;
 
+        // Definition, with its entries and name index, is allocated
+        // from resource.
+        std::any DeserializeConstruction(rapidjson::Value& value,
+                                         std::pmr::memory_resource* resource)
+                                         const override;
+
+        void WriteValue(const std::any& v, JsonWriter& writer) const override;
+
+        void WriteConstruction(const std::any& v, JsonWriter& writer) const override;
+
+        std::any ReadValue(const std::any& v, JsonReader& reader) const override;
+
+        std::any ReadConstruction(JsonReader& reader) const override;
+
         size_t ValueHash(const std::any& value) const override;
 
         bool CompareValue(const std::any& v1, const std::any& v2) const override;
+
+        bool CanConvertThrough() const override;
+
+        Value ToValue(const std::any& v) const override;
+    };
+
+
+    // EnumFlags
+    struct EnumFlagsHandler: TSys::TypeHandler
+    {
+        EnumFlagsHandler();
+
+        std::string ApiName() const override;
+
+        size_t Hash() const override
+        {
+            return typeid(EnumFlags).hash_code();
+        }
+
+        std::any InitValue() const override;
+
+        std::any CopyValue(const std::any& source) const override;
+
+        std::any FromPython(const boost::python::object& obj) const override;
+
+        boost::python::object ToPython(const std::any& value) const override;
+
+        void SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
+                            rapidjson::Document& doc) const override;
+
+        std::any DeserializeValue(const std::any&, rapidjson::Value& value)
+                                  const override;
+
+        void SerializeConstruction(const std::any& v, rapidjson::Value& value,
+                                   rapidjson::Document& doc)
+                                   const override;
+
+        std::any DeserializeConstruction(rapidjson::Value& value)
+                                         const override;
+
+        // Definition, with its entries and name index, is allocated
+        // from resource.
+        std::any DeserializeConstruction(rapidjson::Value& value,
+                                         std::pmr::memory_resource* resource)
+                                         const override;
+
+        void WriteValue(const std::any& v, JsonWriter& writer) const override;
+
+        void WriteConstruction(const std::any& v, JsonWriter& writer) const override;
+
+        std::any ReadValue(const std::any& v, JsonReader& reader) const override;
+
+        std::any ReadConstruction(JsonReader& reader) const override;
+
+        size_t ValueHash(const std::any& value) const override;
+
+        bool CompareValue(const std::any& v1, const std::any& v2) const override;
+
+        bool CanConvertThrough() const override;
+
+        Value ToValue(const std::any& v) const override;
     };
 
 
@@ -390,6 +1238,11 @@ namespace TSys
         std::any DeserializeValue(const std::any&, rapidjson::Value& value)
                                   const override;
 
+        // Wrapped value is deserialized with resource.
+        std::any DeserializeValue(const std::any& v, rapidjson::Value& value,
+                                  std::pmr::memory_resource* resource)
+                                  const override;
+
         void SerializeConstruction(const std::any& v, rapidjson::Value& value,
                                    rapidjson::Document& doc)
                                    const override;
@@ -397,9 +1250,21 @@ namespace TSys
         std::any DeserializeConstruction(rapidjson::Value& value)
                                          const override;
 
+        void WriteValue(const std::any& v, JsonWriter& writer) const override;
+
+        void WriteConstruction(const std::any& v, JsonWriter& writer) const override;
+
+        std::any ReadValue(const std::any& v, JsonReader& reader) const override;
+
+        std::any ReadConstruction(JsonReader& reader) const override;
+
         size_t ValueHash(const std::any& val) const override;
 
         bool CompareValue(const std::any& v1, const std::any& v2) const override;
+
+        bool CanConvertThrough() const override;
+
+        Value ToValue(const std::any& v) const override;
     };
 
 
@@ -437,6 +1302,14 @@ namespace TSys
         std::any DeserializeConstruction(rapidjson::Value& value)
                                          const override;
 
+        void WriteValue(const std::any& v, JsonWriter& writer) const override;
+
+        void WriteConstruction(const std::any& v, JsonWriter& writer) const override;
+
+        std::any ReadValue(const std::any& v, JsonReader& reader) const override;
+
+        std::any ReadConstruction(JsonReader& reader) const override;
+
         size_t ValueHash(const std::any& val) const override;
     };
 
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <any>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+#include "rapidjson/document.h"
+
+#include "tsys.h"
+
+#include "api.h"
+
+
+namespace TSys
+{
+    typedef std::pair<std::string, std::any> NamedValue;
+
+
+    /**
+     * Incremental serializer, remembers each slot type and ValueHash
+     * from the previous save and only writes slots whose hash or type
+     * changed, along with the slots that disappeared.
+     * Delta layout:
+     * {
+     *     "set": {key: [typeName, [construction...], [value...]], ...},
+     *     "removed": [key, ...]
+     * }
+     * The first delta holds every slot, it is a full save that later
+     * deltas are applied onto.
+     */
+    class TSYS_API DeltaSerializer
+    {
+    protected:
+        struct Slot
+        {
+            TypeId type = InvalidTypeId;
+            size_t hash = 0;
+            uint64_t generation = 0;
+        };
+
+        std::unordered_map<std::string, Slot> slots;
+        uint64_t generation = 0;
+
+    public:
+        /**
+         * Serializes values that changed since last call.
+         * @param const std::vector<NamedValue>& values: every current slot,
+         * keys are unique.
+         * @param rapidjson::Value& delta: result delta.
+         * @param rapidjson::Document& doc: document.
+         * @return size_t number of set and removed slots.
+         */
+        size_t Serialize(const std::vector<NamedValue>& values,
+                         rapidjson::Value& delta, rapidjson::Document& doc);
+
+        /**
+         * Forgets previous save, next delta holds every slot.
+         */
+        void Reset();
+
+        /**
+         * Applies delta onto a base document, an object of key to
+         * [typeName, [construction...], [value...]] entries, as the
+         * "set" member of a full delta.
+         * @param const rapidjson::Value& delta: delta.
+         * @param rapidjson::Value& base: base object, updated.
+         * @param rapidjson::Document& doc: base document.
+         * @return bool success, false if a removed key is not a string.
+         */
+        static bool Apply(const rapidjson::Value& delta, rapidjson::Value& base,
+                          rapidjson::Document& doc);
+
+        /**
+         * Applies delta onto deserialized values.
+         * @param rapidjson::Value& delta: delta.
+         * @param std::unordered_map<std::string, std::any>& values: values, updated.
+         * @return bool success, false if an entry could not be read or
+         * a removed key is not a string.
+         */
+        static bool Apply(rapidjson::Value& delta,
+                          std::unordered_map<std::string, std::any>& values);
+
+        /**
+         * Reads one [typeName, [construction...], [value...]] entry.
+         * @param rapidjson::Value& entry: entry.
+         * @return std::any value, empty if type is unknown or entry invalid.
+         */
+        static std::any ReadEntry(rapidjson::Value& entry);
+    };
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <any>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "tsys.h"
+
+#include "api.h"
+
+
+namespace TSys
+{
+    typedef std::pair<TypeHandlerPtr, std::any> HandlerValue;
+
+
+    /**
+     * Serializes values to a json array holding one [typeName, value...]
+     * array per value, as written by TypeHandler::WriteValue.
+     * Values are split in contiguous chunks written by worker threads
+     * into their own buffers, chunks are then joined in order so that
+     * output is byte-identical to writing every value in sequence with
+     * a single rapidjson::Writer.
+     * @param const std::vector<HandlerValue>& values: handler and value pairs,
+     * a null handler writes an empty array.
+     * @param unsigned int threads: number of threads, 0 for hardware concurrency.
+     * @return std::string json array.
+     */
+    TSYS_API std::string SerializeValues(const std::vector<HandlerValue>& values,
+                                         unsigned int threads=0);
+}
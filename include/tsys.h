@@ -7,15 +7,28 @@
 #include <vector>
 #include <set>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <memory>
+#include <memory_resource>
 #include <typeinfo>
 #include <typeindex>
 #include <any>
 #include <functional>
+#include <atomic>
+#include <mutex>
+#include <limits>
+#include <cstdint>
+#include <type_traits>
+#include <cstddef>
+#include <cmath>
+#include <new>
 
 #include "rapidjson/document.h"
 #include "boost/python.hpp"
 
 #include "api.h"
+#include "batchKernels.h"
 
 #ifndef NODELIBRARY2_ATTRIBUTE_CONFIG
 #define NODELIBRARY2_ATTRIBUTE_CONFIG
@@ -26,17 +39,657 @@ namespace TSys
     template<typename From, typename To>
     struct StaticCastConverter
     {
+        typedef To BatchTarget;
+
         [[nodiscard]]
         std::any operator()(const std::any& from, const std::any& current) const
         {
             return std::make_any<To>(static_cast<To>(std::any_cast<From>(from)));
         }
+
+        static void Batch(const From* sources, To* results, size_t count)
+        {
+            BatchKernel<From, To>::Run(sources, results, count);
+        }
     };
 
 
     typedef std::function<std::any(const std::any&, const std::any&)> Converter;
 
 
+    typedef void (*BatchFunction)(const void* sources, void* results, size_t count);
+
+
+    /**
+     * Unboxed conversion of contiguous values, provided by converters
+     * declaring a BatchTarget type and a static
+     * Batch(const From*, BatchTarget*, size_t) kernel.
+     */
+    struct BatchConverter
+    {
+        BatchFunction function = nullptr;
+        std::type_index target = std::type_index(typeid(void));
+    };
+
+
+    /**
+     * Converters of a registered handler, copied by the registry
+     * when it publishes a table so that readers never see them
+     * being modified.
+     */
+    struct ConverterSet
+    {
+        std::unordered_map<std::type_index, Converter> converters;
+        std::unordered_map<std::type_index, BatchConverter> batchConverters;
+    };
+
+
+    template<class C, class = void>
+    struct HasBatchKernel: std::false_type {};
+
+    template<class C>
+    struct HasBatchKernel<C, std::void_t<typename C::BatchTarget>>: std::true_type {};
+
+
+    template<class C, class From>
+    void RunBatchKernel(const void* sources, void* results, size_t count)
+    {
+        C::Batch(static_cast<const From*>(sources),
+                 static_cast<typename C::BatchTarget*>(results),
+                 count);
+    }
+
+
+    /**
+     * Dense identifier given by the registry to each type, stable
+     * for the whole process lifetime. Unlike type_info::hash_code()
+     * it can directly index tables.
+     */
+    typedef uint32_t TypeId;
+
+    constexpr TypeId InvalidTypeId = std::numeric_limits<TypeId>::max();
+
+
+    template<class T>
+    TypeId TypeIdOf();
+
+
+    /**
+     * Type erased value, tagged with its dense TypeId.
+     * Values up to InlineSize bytes (strings, enums, small PODs)
+     * are stored inline without heap allocation, larger ones are
+     * boxed. Unlike std::any, type checks are a single id compare.
+     */
+    class TSYS_API Value
+    {
+    public:
+        static constexpr size_t InlineSize = 32;
+
+    private:
+        struct Operations
+        {
+            void (*copy)(const void* source, void* target);
+            void (*move)(void* source, void* target);
+            void (*destroy)(void* storage);
+            const void* (*get)(const void* storage);
+            std::any (*toAny)(const void* storage);
+            const std::type_info& type;
+        };
+
+        template<class T>
+        static constexpr bool IsInline = (sizeof(T) <= InlineSize &&
+                                          alignof(T) <= alignof(std::max_align_t) &&
+                                          std::is_nothrow_move_constructible_v<T>);
+
+        template<class T, bool Inline = IsInline<T>>
+        struct Model
+        {
+            static void Copy(const void* source, void* target)
+            {
+                new (target) T(*static_cast<const T*>(source));
+            }
+
+            static void Move(void* source, void* target)
+            {
+                new (target) T(std::move(*static_cast<T*>(source)));
+                static_cast<T*>(source)->~T();
+            }
+
+            static void Destroy(void* storage)
+            {
+                static_cast<T*>(storage)->~T();
+            }
+
+            static const void* Get(const void* storage)
+            {
+                return storage;
+            }
+
+            template<class... Args>
+            static T* Create(void* storage, Args&&... args)
+            {
+                return new (storage) T(std::forward<Args>(args)...);
+            }
+        };
+
+        template<class T>
+        struct Model<T, false>
+        {
+            static void Copy(const void* source, void* target)
+            {
+                *static_cast<T**>(target) = new T(**static_cast<T* const*>(source));
+            }
+
+            static void Move(void* source, void* target)
+            {
+                *static_cast<T**>(target) = *static_cast<T**>(source);
+            }
+
+            static void Destroy(void* storage)
+            {
+                delete *static_cast<T**>(storage);
+            }
+
+            static const void* Get(const void* storage)
+            {
+                return *static_cast<T* const*>(storage);
+            }
+
+            template<class... Args>
+            static T* Create(void* storage, Args&&... args)
+            {
+                return *static_cast<T**>(storage) = new T(std::forward<Args>(args)...);
+            }
+        };
+
+        template<class T>
+        static std::any ToAny(const void* storage)
+        {
+            return std::make_any<T>(*static_cast<const T*>(Model<T>::Get(storage)));
+        }
+
+        template<class T>
+        static const Operations* OperationsOf()
+        {
+            static const Operations operations = {
+                    &Model<T>::Copy, &Model<T>::Move, &Model<T>::Destroy,
+                    &Model<T>::Get, &ToAny<T>, typeid(T)
+            };
+
+            return &operations;
+        }
+
+        alignas(std::max_align_t) unsigned char storage[InlineSize];
+        const Operations* operations = nullptr;
+        TypeId id = InvalidTypeId;
+
+        void Steal(Value& other) noexcept
+        {
+            if (other.operations)
+            {
+                other.operations->move(other.storage, storage);
+                operations = other.operations;
+                id = other.id;
+
+                other.operations = nullptr;
+                other.id = InvalidTypeId;
+            }
+        }
+
+    public:
+        Value() = default;
+
+        template<class T, class D = std::decay_t<T>,
+                 class = std::enable_if_t<!std::is_same_v<D, Value> &&
+                                          !std::is_same_v<D, std::any>>>
+        explicit Value(T&& v)
+        {
+            Emplace<D>(std::forward<T>(v));
+        }
+
+        Value(const Value& other)
+        {
+            if (other.operations)
+            {
+                other.operations->copy(other.storage, storage);
+                operations = other.operations;
+                id = other.id;
+            }
+        }
+
+        Value(Value&& other) noexcept
+        {
+            Steal(other);
+        }
+
+        Value& operator=(const Value& other)
+        {
+            if (this != &other)
+            {
+                Value copy(other);
+                *this = std::move(copy);
+            }
+
+            return *this;
+        }
+
+        Value& operator=(Value&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Reset();
+                Steal(other);
+            }
+
+            return *this;
+        }
+
+        ~Value()
+        {
+            Reset();
+        }
+
+        template<class T, class... Args>
+        T& Emplace(Args&&... args)
+        {
+            Reset();
+
+            T* result = Model<T>::Create(storage, std::forward<Args>(args)...);
+
+            operations = OperationsOf<T>();
+            id = TypeIdOf<T>();
+            return *result;
+        }
+
+        void Reset()
+        {
+            if (operations)
+            {
+                operations->destroy(storage);
+                operations = nullptr;
+                id = InvalidTypeId;
+            }
+        }
+
+        bool HasValue() const
+        {
+            return operations != nullptr;
+        }
+
+        TypeId Id() const
+        {
+            return id;
+        }
+
+        const std::type_info& Type() const
+        {
+            return operations ? operations->type : typeid(void);
+        }
+
+        template<class T>
+        bool Is() const
+        {
+            return (operations && id == TypeIdOf<T>());
+        }
+
+        template<class T>
+        const T* Get() const
+        {
+            if (!Is<T>())
+                return nullptr;
+
+            return static_cast<const T*>(operations->get(storage));
+        }
+
+        template<class T>
+        T* Get()
+        {
+            return const_cast<T*>(static_cast<const Value*>(this)->Get<T>());
+        }
+
+        /**
+         * Moves held value out, leaving this value empty.
+         * @return T value, default constructed if type does not match.
+         */
+        template<class T>
+        T Take()
+        {
+            T* value = Get<T>();
+            if (!value)
+                return T();
+
+            T result(std::move(*value));
+            Reset();
+            return result;
+        }
+
+        std::any ToAny() const
+        {
+            if (!operations)
+                return {};
+
+            return operations->toAny(storage);
+        }
+    };
+
+
+    /**
+     * Type erased json writer, following rapidjson Handler concept so
+     * that it can also receive rapidjson::Value::Accept events.
+     * Lets handlers stream to any rapidjson::Writer without building
+     * a document first.
+     */
+    struct TSYS_API JsonWriter
+    {
+        typedef char Ch;
+
+        virtual ~JsonWriter() = default;
+
+        virtual bool Null() = 0;
+        virtual bool Bool(bool b) = 0;
+        virtual bool Int(int i) = 0;
+        virtual bool Uint(unsigned u) = 0;
+        virtual bool Int64(int64_t i) = 0;
+        virtual bool Uint64(uint64_t u) = 0;
+        virtual bool Double(double d) = 0;
+        virtual bool RawNumber(const Ch* str, rapidjson::SizeType length, bool copy) = 0;
+        virtual bool String(const Ch* str, rapidjson::SizeType length, bool copy) = 0;
+        virtual bool StartObject() = 0;
+        virtual bool Key(const Ch* str, rapidjson::SizeType length, bool copy) = 0;
+        virtual bool EndObject(rapidjson::SizeType memberCount) = 0;
+        virtual bool StartArray() = 0;
+        virtual bool EndArray(rapidjson::SizeType elementCount) = 0;
+
+        bool String(std::string_view str)
+        {
+            return String(str.data(), (rapidjson::SizeType)str.size(), true);
+        }
+
+        /**
+         * Writes a type name element, read back as a string.
+         * Compact writers override it to store each name once.
+         * @param const std::string& name: type api name.
+         * @return bool success.
+         */
+        virtual bool TypeName(const std::string& name)
+        {
+            return String(name);
+        }
+
+        /**
+         * Writes a single precision number, json writers override it to
+         * print the shortest text reading back to the same float.
+         * @param float f: number.
+         * @return bool success.
+         */
+        virtual bool Float(float f)
+        {
+            return Double(f);
+        }
+
+        static constexpr size_t ShortestBufferSize = 32;
+
+        /**
+         * Formats finite number to the shortest text reading back to the
+         * same value, always with a decimal point or exponent.
+         * @param double d: number.
+         * @param char* buffer: output, ShortestBufferSize chars.
+         * @return size_t text length.
+         */
+        static size_t FormatShortest(double d, char* buffer);
+
+        /**
+         * Formats finite number to the shortest text reading back to the
+         * same float, always with a decimal point or exponent.
+         * @param float f: number.
+         * @param char* buffer: output, ShortestBufferSize chars.
+         * @return size_t text length.
+         */
+        static size_t FormatShortest(float f, char* buffer);
+    };
+
+
+    /**
+     * JsonWriter forwarding to a rapidjson::Writer (or PrettyWriter)
+     * over any output stream.
+     * Floating point numbers are printed with their shortest round-trip
+     * text, parse with kParseFullPrecisionFlag to read them back exactly.
+     */
+    template<class Writer>
+    struct JsonWriterAdapter: JsonWriter
+    {
+        Writer& writer;
+
+        explicit JsonWriterAdapter(Writer& w): writer(w) {}
+
+        bool Null() override { return writer.Null(); }
+        bool Bool(bool b) override { return writer.Bool(b); }
+        bool Int(int i) override { return writer.Int(i); }
+        bool Uint(unsigned u) override { return writer.Uint(u); }
+        bool Int64(int64_t i) override { return writer.Int64(i); }
+        bool Uint64(uint64_t u) override { return writer.Uint64(u); }
+
+        bool Double(double d) override
+        {
+            if (!std::isfinite(d))
+            {
+                return writer.Double(d);
+            }
+
+            char buffer[ShortestBufferSize];
+            return writer.RawNumber(buffer, (rapidjson::SizeType)FormatShortest(d, buffer), true);
+        }
+
+        bool Float(float f) override
+        {
+            if (!std::isfinite(f))
+            {
+                return writer.Double(f);
+            }
+
+            char buffer[ShortestBufferSize];
+            return writer.RawNumber(buffer, (rapidjson::SizeType)FormatShortest(f, buffer), true);
+        }
+
+
+        bool RawNumber(const Ch* str, rapidjson::SizeType length, bool copy) override
+        {
+            return writer.RawNumber(str, length, copy);
+        }
+
+        bool String(const Ch* str, rapidjson::SizeType length, bool copy) override
+        {
+            return writer.String(str, length, copy);
+        }
+
+        bool StartObject() override { return writer.StartObject(); }
+
+        bool Key(const Ch* str, rapidjson::SizeType length, bool copy) override
+        {
+            return writer.Key(str, length, copy);
+        }
+
+        bool EndObject(rapidjson::SizeType memberCount) override { return writer.EndObject(memberCount); }
+        bool StartArray() override { return writer.StartArray(); }
+        bool EndArray(rapidjson::SizeType elementCount) override { return writer.EndArray(elementCount); }
+
+        using JsonWriter::String;
+    };
+
+
+    /**
+     * Pull json reader, the current token is the next one not consumed
+     * yet, Next() moves to the following one.
+     * Tokens are received following rapidjson Handler concept, so that
+     * adapters can feed it from a rapidjson::Reader iterative parse
+     * without building a document.
+     */
+    class TSYS_API JsonReader
+    {
+    public:
+        typedef char Ch;
+
+        enum class Token
+        {
+            None,
+            Null,
+            Bool,
+            Number,
+            String,
+            StartObject,
+            Key,
+            EndObject,
+            StartArray,
+            EndArray,
+            End
+        };
+
+    protected:
+        Token token = Token::None;
+
+        // Current scalar token, strings reference buffer, or input
+        // directly when it outlives the reader.
+        rapidjson::Value current;
+        std::string buffer;
+
+        bool failed = false;
+
+        /**
+         * Sets current token to a string referenced without copy.
+         * @param Token t: String or Key token.
+         * @param const Ch* str: string, must stay valid until next token.
+         * @param rapidjson::SizeType length: string length.
+         * @return bool success.
+         */
+        bool Reference(Token t, const Ch* str, rapidjson::SizeType length);
+
+        /**
+         * Reads next token from input, calling handler functions below.
+         * No function is called once input is complete.
+         * @return bool false on parse error.
+         */
+        virtual bool Read() = 0;
+
+    public:
+        virtual ~JsonReader() = default;
+
+        /**
+         * Moves to next token.
+         * @return bool false on end of input or error, token is then End.
+         */
+        bool Next();
+
+        /**
+         * Returns current token type.
+         * @return Token token.
+         */
+        Token Type() const
+        {
+            return token;
+        }
+
+        /**
+         * Returns current scalar token as a json value, strings stay
+         * valid until next call to Next().
+         * @return const rapidjson::Value& value.
+         */
+        const rapidjson::Value& Current() const
+        {
+            return current;
+        }
+
+        /**
+         * Returns whether input was malformed or did not match what
+         * a handler expected.
+         * @return bool has error.
+         */
+        bool HasError() const
+        {
+            return failed;
+        }
+
+        /**
+         * Flags reader as failed, further calls to Next() return false.
+         */
+        void Fail()
+        {
+            failed = true;
+            token = Token::End;
+        }
+
+        /**
+         * Checks current token type then moves to next token,
+         * flags reader as failed on mismatch.
+         * @param Token t: expected token.
+         * @return bool token matched.
+         */
+        bool Consume(Token t);
+
+        /**
+         * Reads current json value and moves past it.
+         * @param rapidjson::Value& value: result value.
+         * @param rapidjson::Document::AllocatorType& allocator: allocator.
+         * @return bool success.
+         */
+        bool ReadJson(rapidjson::Value& value, rapidjson::Document::AllocatorType& allocator);
+
+        /**
+         * Reads every remaining element of current array, leaving
+         * reader on its EndArray token.
+         * @param rapidjson::Value& array: result array.
+         * @param rapidjson::Document::AllocatorType& allocator: allocator.
+         * @return bool success.
+         */
+        bool ReadElements(rapidjson::Value& array, rapidjson::Document::AllocatorType& allocator);
+
+        bool Null();
+        bool Bool(bool b);
+        bool Int(int i);
+        bool Uint(unsigned u);
+        bool Int64(int64_t i);
+        bool Uint64(uint64_t u);
+        bool Double(double d);
+        bool RawNumber(const Ch* str, rapidjson::SizeType length, bool copy);
+        bool String(const Ch* str, rapidjson::SizeType length, bool copy);
+        bool StartObject();
+        bool Key(const Ch* str, rapidjson::SizeType length, bool copy);
+        bool EndObject(rapidjson::SizeType memberCount);
+        bool StartArray();
+        bool EndArray(rapidjson::SizeType elementCount);
+    };
+
+
+    /**
+     * JsonReader pulling tokens one at a time from a rapidjson::Reader
+     * over any input stream.
+     * With kParseInsituFlag over a rapidjson::InsituStringStream,
+     * strings reference the parsed buffer instead of being copied.
+     */
+    template<class Stream, unsigned parseFlags=rapidjson::kParseDefaultFlags>
+    class JsonReaderAdapter: public JsonReader
+    {
+    protected:
+        rapidjson::Reader reader;
+        Stream& stream;
+
+        bool Read() override
+        {
+            if (reader.IterativeParseComplete())
+            {
+                return true;
+            }
+
+            return reader.template IterativeParseNext<parseFlags>(stream, *this);
+        }
+
+    public:
+        explicit JsonReaderAdapter(Stream& s): stream(s)
+        {
+            reader.IterativeParseInit();
+        }
+    };
+
+
     /**
      * TypeHandler base class.
      * Pure virtual class that should be overriden to create
@@ -47,21 +700,72 @@ namespace TSys
     protected:
         std::unordered_map<std::type_index, Converter> converters;
 
+        std::unordered_map<std::type_index, BatchConverter> batchConverters;
+
+        // Id this handler is registered under, set by the registry
+        // and read concurrently by converting threads.
+        std::atomic<TypeId> registeredId{InvalidTypeId};
+
+        /**
+         * Applies update to converters. Once handler is registered,
+         * converters are shared with reading threads: update is then
+         * applied under the registry lock, which publishes a new
+         * snapshot of them.
+         * @param std::function update: modifies converters.
+         */
+        void UpdateConverters(const std::function<void()>& update);
+
+        /**
+         * Returns batch converter from From, read from the registry
+         * snapshot when handler is registered.
+         * @param std::type_index from: source type.
+         * @return BatchConverter converter, null function if none.
+         */
+        BatchConverter GetBatchConverter(const std::type_index& from) const;
+
+        friend class TypeRegistry;
+
     public:
         template<typename From, typename Converter>
         void RegisterConverter()
         {
-            this->converters[std::type_index(typeid(From))] = Converter();
+            UpdateConverters([this]()
+            {
+                this->converters[std::type_index(typeid(From))] = Converter();
+
+                if constexpr (HasBatchKernel<Converter>::value)
+                {
+                    BatchConverter& batch = this->batchConverters[std::type_index(typeid(From))];
+                    batch.function = &RunBatchKernel<Converter, From>;
+                    batch.target = std::type_index(typeid(typename Converter::BatchTarget));
+                }
+            });
         }
 
         template<typename From>
         void RegisterConverter(Converter cvrt)
         {
-            this->converters[std::type_index(typeid(From))] = cvrt;
+            UpdateConverters([this, &cvrt]()
+            {
+                this->converters[std::type_index(typeid(From))] = cvrt;
+            });
         }
 
         Converter GetConverter(const std::any& from) const;
 
+        /**
+         * Returns converters of this handler. Only safe to iterate
+         * while no other thread registers converters on it.
+         * @return std::unordered_map converters by source type.
+         */
+        const std::unordered_map<std::type_index, Converter>& Converters() const;
+
+        /**
+         * Returns id of the type this handler is registered for.
+         * @return TypeId id, InvalidTypeId if handler is not registered.
+         */
+        TypeId Id() const;
+
     public:
         /**
          * Serializes type value.
@@ -99,6 +803,46 @@ namespace TSys
          */
         virtual std::any DeserializeConstruction(rapidjson::Value& value) const = 0;
 
+        /**
+         * Streams type value, writing the same elements SerializeValue
+         * pushes, into the array currently open on writer.
+         * Default implementation serializes to a temporary document
+         * then replays it, handlers should override it to stream directly.
+         * @param std::any v: value.
+         * @param JsonWriter& writer: json writer.
+         */
+        virtual void WriteValue(const std::any& v, JsonWriter& writer) const;
+
+        /**
+         * Streams type construction, writing the same elements
+         * SerializeConstruction pushes, into the array currently open
+         * on writer.
+         * @param std::any v: value.
+         * @param JsonWriter& writer: json writer.
+         */
+        virtual void WriteConstruction(const std::any& v, JsonWriter& writer) const;
+
+        /**
+         * Reads type value from a pull reader, consuming the elements
+         * WriteValue writes. Reader must be on the first element and is
+         * left on the token following the value.
+         * Default implementation reads the elements into a temporary
+         * document then deserializes it, handlers should override it to
+         * read tokens directly.
+         * @param std::any v: initial value.
+         * @param JsonReader& reader: json reader.
+         * @return std::any value, v if reader failed.
+         */
+        virtual std::any ReadValue(const std::any& v, JsonReader& reader) const;
+
+        /**
+         * Reads type construction from a pull reader, consuming the
+         * elements WriteConstruction writes.
+         * @param JsonReader& reader: json reader.
+         * @return std::any value.
+         */
+        virtual std::any ReadConstruction(JsonReader& reader) const;
+
         /**
          * Initializes base value.
          * @return std::any base value.
@@ -169,7 +913,152 @@ namespace TSys
           */
         virtual bool CanConvertFrom(const std::any& value) const;
 
+        /**
+         * Converts a batch of values, converters are only resolved
+         * when source type changes between consecutive values.
+         * @param std::any* sources: values to convert.
+         * @param std::any* results: current values, replaced by
+         * converted values / empty std::any if conversion failed.
+         * @param size_t count: number of values.
+         * @return size_t number of converted values.
+         */
+        size_t ConvertMany(const std::any* sources, std::any* results, size_t count) const;
+
+        /**
+         * Converts contiguous values, through the batch kernel of the
+         * From converter if it has one, else value by value.
+         * @param From* sources: values to convert.
+         * @param To* results: preallocated results.
+         * @param size_t count: number of values.
+         * @return bool every value was converted.
+         */
+        template<typename From, typename To>
+        bool ConvertMany(const From* sources, To* results, size_t count) const
+        {
+            BatchConverter batch = GetBatchConverter(std::type_index(typeid(From)));
+            if (batch.function && batch.target == std::type_index(typeid(To)))
+            {
+                batch.function(sources, results, count);
+                return true;
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                std::any result = ConvertFrom(std::make_any<From>(sources[i]),
+                                              std::make_any<To>(results[i]));
+
+                To* value = std::any_cast<To>(&result);
+                if (!value)
+                {
+                    return false;
+                }
+
+                results[i] = std::move(*value);
+            }
+
+            return true;
+        }
+
+        /**
+         * Returns whether handled type may be used as an intermediate
+         * step of a multi-hop conversion. Types whose conversions
+         * depend on the current value (like Enum) should return false.
+         * @return bool can convert through.
+         */
+        virtual bool CanConvertThrough() const;
+
         bool operator==(TypeHandler* h) const;
+
+    public:
+        // Value overloads. Defaults box through std::any, typed
+        // handlers override them to work on the held value directly.
+
+        /**
+         * Wraps handled value into a Value.
+         * @param std::any v: value.
+         * @return Value value, empty if handler does not support it.
+         */
+        virtual Value ToValue(const std::any& v) const;
+
+        virtual bool CompareValue(const Value& v1, const Value& v2) const;
+
+        virtual size_t ValueHash(const Value& val) const;
+
+        virtual Value CopyValue(const Value& source) const;
+
+        virtual void SerializeValue(const Value& v, rapidjson::Value& value,
+                                    rapidjson::Document& document) const;
+
+        virtual Value ConvertFrom(const Value& sourceValue, const Value& currentValue) const;
+
+    public:
+        // Memory resource overloads, used by DeserializationArena.
+        // Defaults ignore the resource, handlers of values owning heap
+        // storage override them to take that storage from resource.
+        // Values built this way must not outlive the resource.
+
+        /**
+         * Initializes base value.
+         * @param std::pmr::memory_resource* resource: storage resource.
+         * @return std::any base value.
+         */
+        virtual std::any InitValue(std::pmr::memory_resource* resource) const;
+
+        /**
+         * Deserializes type value.
+         * @param std::any v: value.
+         * @param rapidjson::Value& value: json value.
+         * @param std::pmr::memory_resource* resource: storage resource.
+         * @return std::any deserialized value.
+         */
+        virtual std::any DeserializeValue(const std::any& v, rapidjson::Value& value,
+                                          std::pmr::memory_resource* resource) const;
+
+        /**
+         * Deserializes type construction.
+         * @param rapidjson::Value& value: json value.
+         * @param std::pmr::memory_resource* resource: storage resource.
+         * @return std::any built value.
+         */
+        virtual std::any DeserializeConstruction(rapidjson::Value& value,
+                                                 std::pmr::memory_resource* resource) const;
+    };
+
+
+    /**
+     * Statically dispatched operations on values of type T.
+     * Callers that know T at compile time can use these directly,
+     * without std::any boxing nor virtual calls; handler virtuals
+     * are thin adapters over them.
+     */
+    template<class T>
+    struct TypedHandleBase
+    {
+        static bool Compare(const T& v1, const T& v2)
+        {
+            return (v1 == v2);
+        }
+
+        static size_t Hash(const T& v)
+        {
+            return std::hash<T>{}(v);
+        }
+
+        static T Copy(const T& v)
+        {
+            return v;
+        }
+    };
+
+
+    /**
+     * Typed handle, specialized by types that can also be
+     * serialized statically, see defaultTypes.h.
+     */
+    template<class T>
+    struct TypedHandle: TypedHandleBase<T>
+    {
+
     };
 
 
@@ -183,7 +1072,23 @@ namespace TSys
 
         bool CompareValue(const std::any& v1, const std::any& v2) const override
         {
-            return (std::any_cast<T>(v1) == std::any_cast<T>(v2));
+            return TypedHandle<T>::Compare(std::any_cast<const T&>(v1),
+                                           std::any_cast<const T&>(v2));
+        }
+
+        Value ToValue(const std::any& v) const override
+        {
+            return Value(std::any_cast<const T&>(v));
+        }
+
+        bool CompareValue(const Value& v1, const Value& v2) const override
+        {
+            const T* t1 = v1.Get<T>();
+            const T* t2 = v2.Get<T>();
+            if (!t1 || !t2)
+                return false;
+
+            return TypedHandle<T>::Compare(*t1, *t2);
         }
     };
 
@@ -193,14 +1098,35 @@ namespace TSys
         template<typename From>
         void RegisterConstructibleConverter()
         {
-            this->converters[std::type_index(typeid(From))] = StaticCastConverter<From, T>();
+            this->template RegisterConverter<From, StaticCastConverter<From, T>>();
         }
 
         size_t ValueHash(const std::any& val) const override
         {
-            std::hash<T> hash{};
-            T v = std::any_cast<T>(val);
-            return hash(v);
+            return TypedHandle<T>::Hash(std::any_cast<const T&>(val));
+        }
+
+        std::any CopyValue(const std::any& source) const override
+        {
+            return std::make_any<T>(TypedHandle<T>::Copy(std::any_cast<const T&>(source)));
+        }
+
+        size_t ValueHash(const Value& val) const override
+        {
+            const T* v = val.Get<T>();
+            if (!v)
+                return 0;
+
+            return TypedHandle<T>::Hash(*v);
+        }
+
+        Value CopyValue(const Value& source) const override
+        {
+            const T* v = source.Get<T>();
+            if (!v)
+                return {};
+
+            return Value(TypedHandle<T>::Copy(*v));
         }
     };
 
@@ -208,13 +1134,161 @@ namespace TSys
     typedef std::shared_ptr<TypeHandler> TypeHandlerPtr;
 
 
+    /**
+     * Chain of converters going from a source type to a target
+     * type through intermediate registered types.
+     */
+    struct TSYS_API ConversionPath
+    {
+        struct Step
+        {
+            Converter converter;
+
+            // Handler of the step result type, provides the current
+            // value given to intermediate converters.
+            TypeHandlerPtr handler;
+        };
+
+        std::vector<Step> steps;
+
+        /**
+         * Runs every step of the chain.
+         * @param std::any sourceValue: value.
+         * @param std::any currentValue: current target value, given
+         * to the last step only.
+         * @return std::any result value, empty if a step failed.
+         */
+        std::any Convert(const std::any& sourceValue, const std::any& currentValue) const;
+    };
+
+
+    typedef std::any (*ConvertFunction)(const void* context, const std::any& sourceValue,
+                                        const std::any& currentValue);
+
+
+    /**
+     * Entry of the registry conversion matrix: converting is a
+     * single indirect call of function with context.
+     */
+    struct ConversionSlot
+    {
+        ConvertFunction function = nullptr;
+        const void* context = nullptr;
+
+        std::any operator()(const std::any& sourceValue, const std::any& currentValue) const
+        {
+            return function(context, sourceValue, currentValue);
+        }
+    };
+
+
     class TSYS_API TypeRegistry
 	{
-    private:
-        static TypeRegistry* registry;
-
 	protected:
-        std::unordered_map<std::type_index, TypeHandlerPtr> handlers;
+        /**
+         * Immutable set of registered handlers.
+         * Readers only ever see a fully built table, registration
+         * publishes a modified copy instead of mutating in place.
+         */
+        struct TypeTable
+        {
+            // Every type that received an id, registered or not.
+            std::unordered_map<std::type_index, TypeId> typeIds;
+            std::unordered_map<size_t, TypeId> hashIds;
+
+            // Handlers indexed by TypeId, empty for types that only
+            // have an id.
+            std::vector<TypeHandlerPtr> handlers;
+
+            // Api names are cached once per registered type, so name
+            // lookups neither scan the handlers nor call ApiName().
+            // Views in handlersByName point into the apiNames value of
+            // the type owning the entry, which is node based and
+            // therefore stable.
+            std::unordered_map<std::type_index, std::string> apiNames;
+            std::unordered_map<std::string_view, TypeHandlerPtr> handlersByName;
+
+            // Converters of each handler, indexed by TypeId. Shared
+            // between tables until the handler converters change.
+            std::vector<std::shared_ptr<const ConverterSet>> converterSets;
+
+            // Incremented by each published table, including the ones
+            // publishing new converters of a registered handler. Unlike
+            // addresses it is never reused once the table is freed.
+            uint64_t revision = 0;
+
+            TypeTable() = default;
+
+            TypeTable(const TypeTable& other);
+
+            TypeTable& operator=(const TypeTable&) = delete;
+        };
+
+        // Currently published table, read without locking.
+        std::atomic<const TypeTable*> table;
+
+        // Owner of the published table.
+        std::unique_ptr<const TypeTable> currentTable;
+
+        // Replaced tables with the epoch they were retired at, freed
+        // once every reader has left that epoch, see ReadGuard.
+        std::vector<std::pair<std::unique_ptr<const TypeTable>, uint64_t>> retiredTables;
+
+        // Serializes writers.
+        std::mutex registerMutex;
+
+        /**
+         * Shortest conversion paths between every pair of types,
+         * computed from the TypeTable of a given revision.
+         */
+        struct ConversionTable
+        {
+            uint64_t typesRevision = 0;
+
+            // Square matrices indexed by (from * size + to).
+            size_t size = 0;
+            std::vector<ConversionPath> paths;
+            std::vector<ConversionSlot> slots;
+        };
+
+        mutable std::atomic<const ConversionTable*> conversions{nullptr};
+
+        mutable std::unique_ptr<const ConversionTable> currentConversions;
+
+        // Stale conversion tables, freed like retired tables.
+        mutable std::vector<std::pair<std::unique_ptr<const ConversionTable>, uint64_t>> retiredConversions;
+
+        mutable std::mutex conversionMutex;
+
+        const ConversionTable& Conversions() const;
+
+        const TypeTable& Table() const
+        {
+            return *table.load(std::memory_order_acquire);
+        }
+
+        /**
+         * Publishes next as the current table, retiring the previous
+         * one. Must be called with registerMutex locked.
+         * @param std::unique_ptr<TypeTable> next: table to publish.
+         */
+        void Publish(std::unique_ptr<TypeTable> next);
+
+        static TypeId AddTypeId(TypeTable& t, const std::type_index& type);
+
+        static std::shared_ptr<const ConverterSet> SnapshotConverters(const TypeHandler& handler);
+
+        /**
+         * Applies update to converters of a registered handler, then
+         * publishes a table with the new converters.
+         * @param TypeHandler& handler: handler.
+         * @param std::function update: modifies handler converters.
+         */
+        void UpdateConverters(TypeHandler& handler, const std::function<void()>& update);
+
+        friend struct TypeHandler;
+
+        static void BuildConversions(const TypeTable& types, ConversionTable& table);
 
         /**
          * Constructor (default).
@@ -222,6 +1296,25 @@ namespace TSys
         TypeRegistry();
 
 	public:
+        /**
+         * Pins the tables read by the current thread: tables and
+         * conversions returned by the registry are not freed while
+         * a guard lives. Registry methods take one internally, a
+         * guard is only needed around FindTypeHandle, GetConversion
+         * and GetConversionPath results. Guards can be nested.
+         */
+        class TSYS_API ReadGuard
+        {
+        public:
+            ReadGuard();
+
+            ~ReadGuard();
+
+            ReadGuard(const ReadGuard&) = delete;
+
+            ReadGuard& operator=(const ReadGuard&) = delete;
+        };
+
         bool RegisterType(
                 const std::type_index& t,
                 const TypeHandlerPtr& handler,
@@ -250,6 +1343,28 @@ namespace TSys
             );
         }
 
+        /**
+         * Returns id of specified type, reserving a new one if the
+         * type never got one.
+         * @param std::type_index t: type.
+         * @return TypeId id.
+         */
+        TypeId ReserveTypeId(const std::type_index& t);
+
+        /**
+         * Returns id of specified type, without reserving one.
+         * @param std::type_index t: type.
+         * @return TypeId id, InvalidTypeId if type has none.
+         */
+        TypeId GetTypeId(const std::type_index& t) const;
+
+        /**
+         * Returns id of type with specified type_info::hash_code().
+         * @param size_t hash: type hash.
+         * @return TypeId id, InvalidTypeId if type has none.
+         */
+        TypeId GetTypeIdByHash(size_t hash) const;
+
         bool IsRegistered(const std::type_index& t) const;
 
         bool IsRegistered(const std::type_info& t) const;
@@ -270,15 +1385,93 @@ namespace TSys
 
         TypeHandlerPtr GetTypeHandle(const char* apiName) const;
 
+        TypeHandlerPtr GetTypeHandle(std::string_view apiName) const;
+
+        TypeHandlerPtr GetTypeHandle(TypeId id) const;
+
+        /**
+         * Returns handler of type like GetTypeHandle, without copying
+         * the shared pointer, for lookups on hot paths.
+         * @param TypeId id: type id.
+         * @return const TypeHandler* handler, nullptr if type is not
+         * registered. Remains valid while a ReadGuard is held.
+         */
+        const TypeHandler* FindTypeHandle(TypeId id) const;
+
+        /**
+         * Returns handler of type like GetTypeHandle, without copying
+         * the shared pointer, for lookups on hot paths.
+         * @param std::type_index t: type.
+         * @return const TypeHandler* handler, nullptr if type is not
+         * registered. Remains valid while a ReadGuard is held.
+         */
+        const TypeHandler* FindTypeHandle(const std::type_index& t) const;
+
+        /**
+         * Returns handler of type with specified type_info::hash_code().
+         * Named apart from GetTypeHandle(TypeId), size_t and TypeId
+         * being the same type on 32 bit targets.
+         * @param size_t hash: type hash.
+         * @return TypeHandlerPtr handler, null if type is not registered.
+         */
+        TypeHandlerPtr GetTypeHandleByHash(size_t hash) const;
+
         template<class T>
-        TypeHandlerPtr GetTypeHandle() const
-        {
-            return GetTypeHandle(typeid(T));
-        }
+        TypeHandlerPtr GetTypeHandle() const;
+
+        /**
+         * Returns shortest chain of registered converters going
+         * from one type to another. Paths are computed once and
+         * recomputed only after types or converters are registered.
+         * @param TypeId from: source type.
+         * @param TypeId to: target type.
+         * @return ConversionPath* path, nullptr if types are not
+         * convertible. Remains valid while a ReadGuard is held.
+         */
+        const ConversionPath* GetConversionPath(TypeId from, TypeId to) const;
+
+        /**
+         * Returns precomputed conversion from one type to another.
+         * @param TypeId from: source type.
+         * @param TypeId to: target type.
+         * @return ConversionSlot* conversion, nullptr if types are not
+         * convertible. Remains valid while a ReadGuard is held.
+         */
+        const ConversionSlot* GetConversion(TypeId from, TypeId to) const;
+
+        /**
+         * Returns batch converter registered by type to from type from.
+         * @param TypeId to: target type.
+         * @param std::type_index from: source type.
+         * @return BatchConverter converter, null function if none.
+         */
+        BatchConverter GetBatchConverter(TypeId to, const std::type_index& from) const;
 
         static TypeRegistry* GetRegistry();
 	};
 
+
+    /**
+     * Returns dense id of type T. Id is resolved once then cached,
+     * so that hot paths can index the registry directly.
+     * @return TypeId id.
+     */
+    template<class T>
+    TypeId TypeIdOf()
+    {
+        static const TypeId id = TypeRegistry::GetRegistry()->ReserveTypeId(
+                std::type_index(typeid(T)));
+
+        return id;
+    }
+
+
+    template<class T>
+    TypeHandlerPtr TypeRegistry::GetTypeHandle() const
+    {
+        return GetTypeHandle(TypeIdOf<T>());
+    }
+
 }
 
 #endif // NODELIBRARY2_ATTRIBUTE_CONFIG
\ No newline at end of file
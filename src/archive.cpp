@@ -0,0 +1,640 @@
+#include "include/archive.h"
+#include "include/binary.h"
+#include "include/defaultTypes.h"
+
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+// Archive layout, integers are little-endian:
+//   header:      magic, version
+//   entries:     binary tokens, handler type name, [construction], [value]
+//   keys:        key bytes
+//   type table:  varint count, then varint length and bytes per name
+//   enum table:  binary tokens, enum definitions referenced by entries
+//   index:       IndexRecordSize bytes per entry, sorted by key
+//   footer:      type table offset, enum table offset, index offset,
+//                entry count, magic
+static constexpr char ArchiveMagic[4] = {'T', 'S', 'Y', 'A'};
+static constexpr uint8_t ArchiveVersion = 2;
+
+static constexpr size_t HeaderSize = sizeof(ArchiveMagic) + 1;
+
+// Key offset, key length, entry offset, entry size.
+static constexpr size_t IndexRecordSize = 8 + 4 + 8 + 8;
+
+static constexpr size_t FooterSize = 8 + 8 + 8 + 8 + sizeof(ArchiveMagic);
+
+
+static void AppendFixed(std::string& out, uint64_t v, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        out.push_back((char)(v >> (8 * i)));
+    }
+}
+
+
+static void AppendVarint(std::string& out, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        out.push_back((char)((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+
+    out.push_back((char)v);
+}
+
+
+static uint64_t GetFixed(const char* p, size_t size)
+{
+    uint64_t v = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        v |= (uint64_t)(uint8_t)p[i] << (8 * i);
+    }
+
+    return v;
+}
+
+
+static bool GetVarint(const char*& p, const char* end, uint64_t& v)
+{
+    v = 0;
+    for (unsigned int shift = 0; shift < 64 && p != end; shift += 7)
+    {
+        auto byte = (uint8_t)*p++;
+        v |= (uint64_t)(byte & 0x7f) << shift;
+
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+namespace
+{
+    // Entry tokens only reference the archive type table.
+    class EntryWriter: public TSys::BinaryWriter
+    {
+    protected:
+        std::unordered_map<std::string, uint32_t>& typeIds;
+        std::vector<std::string>& typeNames;
+
+    public:
+        EntryWriter(std::string& out, std::unordered_map<std::string, uint32_t>& ids,
+                    std::vector<std::string>& names):
+            BinaryWriter(out, false), typeIds(ids), typeNames(names)
+        {
+
+        }
+
+        bool TypeName(const std::string& name) override
+        {
+            auto iter = typeIds.find(name);
+            if (iter == typeIds.end())
+            {
+                iter = typeIds.emplace(name, (uint32_t)typeNames.size()).first;
+                typeNames.push_back(name);
+            }
+
+            Put(TSys::Binary::Tag::TypeReference);
+            PutVarint(iter->second);
+            return true;
+        }
+    };
+
+
+    // Tokens of the enum table, which holds no type names.
+    class TableWriter: public TSys::BinaryWriter
+    {
+    public:
+        explicit TableWriter(std::string& out): BinaryWriter(out, false)
+        {
+
+        }
+    };
+
+
+    class EntryReader: public TSys::BinaryReader
+    {
+    public:
+        EntryReader(std::string_view entry, const std::vector<std::string_view>& names):
+            BinaryReader(entry)
+        {
+            headerRead = true;
+            typeNames = names;
+        }
+    };
+}
+
+
+TSys::MappedFile::~MappedFile()
+{
+    Close();
+}
+
+
+bool TSys::MappedFile::Open(const std::string& path)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || !fileSize.QuadPart)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+
+    if (!mapping)
+    {
+        return false;
+    }
+
+    // The view keeps the mapping alive.
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+
+    if (!view)
+    {
+        return false;
+    }
+
+    data = static_cast<const char*>(view);
+    size = (size_t)fileSize.QuadPart;
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat status{};
+    if (fstat(file, &status) != 0 || !status.st_size)
+    {
+        close(file);
+        return false;
+    }
+
+    void* view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+
+    data = static_cast<const char*>(view);
+    size = (size_t)status.st_size;
+#endif
+
+    return true;
+}
+
+
+void TSys::MappedFile::Close()
+{
+    if (!data)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap(const_cast<char*>(data), size);
+#endif
+
+    data = nullptr;
+    size = 0;
+}
+
+
+const char* TSys::MappedFile::Data() const
+{
+    return data;
+}
+
+
+size_t TSys::MappedFile::Size() const
+{
+    return size;
+}
+
+
+TSys::ArchiveWriter::ArchiveWriter()
+{
+    body.append(ArchiveMagic, sizeof(ArchiveMagic));
+    body.push_back((char)ArchiveVersion);
+}
+
+
+bool TSys::ArchiveWriter::Add(const std::string& key, const std::any& value)
+{
+    auto handler = TypeRegistry::GetRegistry()->GetTypeHandle(value);
+    if (!handler)
+    {
+        return false;
+    }
+
+    size_t offset = body.size();
+
+    // Enum definitions are written once, in the enum table.
+    EnumSchemaScope scope(enumTable);
+
+    EntryWriter writer(body, typeIds, typeNames);
+    writer.TypeName(handler->ApiName());
+
+    writer.StartArray();
+    handler->WriteConstruction(value, writer);
+    writer.EndArray(0);
+
+    writer.StartArray();
+    handler->WriteValue(value, writer);
+    writer.EndArray(0);
+
+    entries[key] = {offset, body.size() - offset};
+    return true;
+}
+
+
+std::string TSys::ArchiveWriter::Data() const
+{
+    std::string result = body;
+
+    std::vector<uint64_t> keyOffsets;
+    keyOffsets.reserve(entries.size());
+
+    for (const auto& entry : entries)
+    {
+        keyOffsets.push_back(result.size());
+        result.append(entry.first);
+    }
+
+    uint64_t typeTableOffset = result.size();
+
+    AppendVarint(result, typeNames.size());
+    for (const auto& name : typeNames)
+    {
+        AppendVarint(result, name.size());
+        result.append(name);
+    }
+
+    uint64_t enumTableOffset = result.size();
+
+    TableWriter writer(result);
+    enumTable.Write(writer);
+
+    uint64_t indexOffset = result.size();
+
+    size_t i = 0;
+    for (const auto& entry : entries)
+    {
+        AppendFixed(result, keyOffsets[i++], 8);
+        AppendFixed(result, entry.first.size(), 4);
+        AppendFixed(result, entry.second.first, 8);
+        AppendFixed(result, entry.second.second, 8);
+    }
+
+    AppendFixed(result, typeTableOffset, 8);
+    AppendFixed(result, enumTableOffset, 8);
+    AppendFixed(result, indexOffset, 8);
+    AppendFixed(result, entries.size(), 8);
+    result.append(ArchiveMagic, sizeof(ArchiveMagic));
+
+    return result;
+}
+
+
+bool TSys::ArchiveWriter::Save(const std::string& path) const
+{
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+        return false;
+    }
+
+    std::string archive = Data();
+    stream.write(archive.data(), (std::streamsize)archive.size());
+
+    return (bool)stream;
+}
+
+
+bool TSys::ArchiveReader::Open(const std::string& path)
+{
+    if (!file.Open(path))
+    {
+        return false;
+    }
+
+    data = file.Data();
+    size = file.Size();
+
+    return Load();
+}
+
+
+bool TSys::ArchiveReader::Open(const char* d, size_t s)
+{
+    file.Close();
+
+    data = d;
+    size = s;
+
+    return Load();
+}
+
+
+bool TSys::ArchiveReader::Load()
+{
+    index = nullptr;
+    count = 0;
+    typeNames.clear();
+    enumTable.Clear();
+
+    if (!data || size < HeaderSize + FooterSize ||
+        std::memcmp(data, ArchiveMagic, sizeof(ArchiveMagic)) != 0 ||
+        (uint8_t)data[sizeof(ArchiveMagic)] != ArchiveVersion ||
+        std::memcmp(data + size - sizeof(ArchiveMagic), ArchiveMagic, sizeof(ArchiveMagic)) != 0)
+    {
+        return false;
+    }
+
+    const char* footer = data + size - FooterSize;
+
+    uint64_t typeTableOffset = GetFixed(footer, 8);
+    uint64_t enumTableOffset = GetFixed(footer + 8, 8);
+    uint64_t indexOffset = GetFixed(footer + 16, 8);
+    uint64_t entryCount = GetFixed(footer + 24, 8);
+
+    uint64_t indexEnd = size - FooterSize;
+    if (typeTableOffset > enumTableOffset || enumTableOffset > indexOffset || indexOffset > indexEnd ||
+        entryCount != (indexEnd - indexOffset) / IndexRecordSize ||
+        (indexEnd - indexOffset) % IndexRecordSize)
+    {
+        return false;
+    }
+
+    const char* cursor = data + typeTableOffset;
+    const char* typeTableEnd = data + enumTableOffset;
+
+    uint64_t typeCount;
+    if (!GetVarint(cursor, typeTableEnd, typeCount))
+    {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < typeCount; i++)
+    {
+        uint64_t length;
+        if (!GetVarint(cursor, typeTableEnd, length) ||
+            (uint64_t)(typeTableEnd - cursor) < length)
+        {
+            typeNames.clear();
+            return false;
+        }
+
+        typeNames.emplace_back(cursor, (size_t)length);
+        cursor += length;
+    }
+
+    // Definitions are read once, entries only reference them.
+    EntryReader reader(std::string_view(data + enumTableOffset, (size_t)(indexOffset - enumTableOffset)),
+                       typeNames);
+    if (!reader.Next() || !enumTable.Read(reader) || reader.Type() != JsonReader::Token::End)
+    {
+        typeNames.clear();
+        enumTable.Clear();
+        return false;
+    }
+
+    index = data + indexOffset;
+    count = (size_t)entryCount;
+
+    return true;
+}
+
+
+size_t TSys::ArchiveReader::Size() const
+{
+    return count;
+}
+
+
+std::string_view TSys::ArchiveReader::Key(size_t i) const
+{
+    if (i >= count)
+    {
+        return {};
+    }
+
+    const char* record = index + i * IndexRecordSize;
+
+    uint64_t offset = GetFixed(record, 8);
+    uint64_t length = GetFixed(record + 8, 4);
+
+    if (offset > size || length > size - offset)
+    {
+        return {};
+    }
+
+    return {data + offset, (size_t)length};
+}
+
+
+bool TSys::ArchiveReader::Find(std::string_view key, std::string_view& entry) const
+{
+    size_t low = 0;
+    size_t high = count;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        int comparison = Key(middle).compare(key);
+        if (comparison < 0)
+        {
+            low = middle + 1;
+        }
+        else if (comparison > 0)
+        {
+            high = middle;
+        }
+        else
+        {
+            const char* record = index + middle * IndexRecordSize;
+
+            uint64_t offset = GetFixed(record + 12, 8);
+            uint64_t length = GetFixed(record + 20, 8);
+
+            if (offset > size || length > size - offset)
+            {
+                return false;
+            }
+
+            entry = std::string_view(data + offset, (size_t)length);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool TSys::ArchiveReader::Contains(std::string_view key) const
+{
+    std::string_view entry;
+    return Find(key, entry);
+}
+
+
+std::string_view TSys::ArchiveReader::TypeName(std::string_view key) const
+{
+    std::string_view entry;
+    if (!Find(key, entry))
+    {
+        return {};
+    }
+
+    EntryReader reader(entry, typeNames);
+    if (!reader.Next() || reader.Type() != JsonReader::Token::String)
+    {
+        return {};
+    }
+
+    return {reader.Current().GetString(), reader.Current().GetStringLength()};
+}
+
+
+bool TSys::ArchiveReader::StringView(std::string_view key, std::string_view& value) const
+{
+    std::string_view entry;
+    if (!Find(key, entry))
+    {
+        return false;
+    }
+
+    auto handler = TypeRegistry::GetRegistry()->GetTypeHandle<std::string>();
+    if (!handler)
+    {
+        return false;
+    }
+
+    std::string name = handler->ApiName();
+
+    // Type name, [construction], [value type name, value].
+    EntryReader reader(entry, typeNames);
+    reader.Next();
+
+    if (reader.Type() != JsonReader::Token::String ||
+        std::string_view(reader.Current().GetString(), reader.Current().GetStringLength()) != name)
+    {
+        return false;
+    }
+
+    reader.Next();
+    if (!reader.Consume(JsonReader::Token::StartArray))
+    {
+        return false;
+    }
+
+    while (reader.Type() != JsonReader::Token::EndArray)
+    {
+        if (!reader.Next())
+        {
+            return false;
+        }
+    }
+
+    reader.Next();
+    if (!reader.Consume(JsonReader::Token::StartArray) ||
+        !reader.Consume(JsonReader::Token::String) ||
+        reader.Type() != JsonReader::Token::String)
+    {
+        return false;
+    }
+
+    value = std::string_view(reader.Current().GetString(), reader.Current().GetStringLength());
+    return true;
+}
+
+
+std::any TSys::ArchiveReader::Value(std::string_view key) const
+{
+    std::string_view entry;
+    if (!Find(key, entry))
+    {
+        return {};
+    }
+
+    // Enums share the definitions of the archive table.
+    EnumSchemaScope scope(enumTable);
+
+    EntryReader reader(entry, typeNames);
+    reader.Next();
+
+    if (reader.Type() != JsonReader::Token::String)
+    {
+        return {};
+    }
+
+    auto handler = TypeRegistry::GetRegistry()->GetTypeHandle(
+            std::string_view(reader.Current().GetString(), reader.Current().GetStringLength()));
+    if (!handler)
+    {
+        return {};
+    }
+
+    reader.Next();
+    if (!reader.Consume(JsonReader::Token::StartArray))
+    {
+        return {};
+    }
+
+    std::any construction = handler->ReadConstruction(reader);
+    if (!reader.Consume(JsonReader::Token::EndArray) ||
+        !reader.Consume(JsonReader::Token::StartArray))
+    {
+        return {};
+    }
+
+    std::any value = handler->ReadValue(construction, reader);
+    if (reader.Type() != JsonReader::Token::EndArray || reader.HasError())
+    {
+        return {};
+    }
+
+    return value;
+}
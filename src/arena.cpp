@@ -0,0 +1,124 @@
+#include "include/arena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
+
+
+// Dom values take about four times the json text size,
+// the pool grows by chunks of that size, from the C heap, if it is
+// not enough.
+static constexpr size_t DomSizeFactor = 4;
+
+static constexpr size_t MinimumChunkSize = 64 * 1024;
+
+// Rapidjson default.
+static constexpr size_t DocumentStackCapacity = 1024;
+
+
+TSys::DeserializationArena::DeserializationArena(std::pmr::memory_resource* upstream):
+    resource(upstream)
+{
+
+}
+
+
+TSys::DeserializationArena::~DeserializationArena()
+{
+    Release();
+}
+
+
+void TSys::DeserializationArena::CreateDocument(size_t length)
+{
+    Release();
+
+    size_t size = std::max(length * DomSizeFactor, MinimumChunkSize);
+    void* buffer = resource.allocate(size, alignof(std::max_align_t));
+
+    allocator = new (resource.allocate(sizeof(rapidjson::MemoryPoolAllocator<>),
+                                       alignof(rapidjson::MemoryPoolAllocator<>)))
+            rapidjson::MemoryPoolAllocator<>(buffer, size, size, &crtAllocator);
+
+    document = new (resource.allocate(sizeof(rapidjson::Document), alignof(rapidjson::Document)))
+            rapidjson::Document(allocator, DocumentStackCapacity, &crtAllocator);
+}
+
+
+rapidjson::Document& TSys::DeserializationArena::Parse(const char* json, size_t length)
+{
+    CreateDocument(length);
+
+    document->Parse(json, length);
+    return *document;
+}
+
+
+rapidjson::Document& TSys::DeserializationArena::ParseInsitu(const char* json, size_t length)
+{
+    CreateDocument(length);
+
+    // Text lives with the document, released along with it.
+    auto text = static_cast<char*>(resource.allocate(length + 1, 1));
+    std::memcpy(text, json, length);
+    text[length] = '\0';
+
+    document->ParseInsitu(text);
+    return *document;
+}
+
+
+rapidjson::Document& TSys::DeserializationArena::ParseInsitu(char* json, size_t length)
+{
+    CreateDocument(length);
+
+    document->ParseInsitu(json);
+    return *document;
+}
+
+
+rapidjson::Document* TSys::DeserializationArena::Document() const
+{
+    return document;
+}
+
+
+std::pmr::memory_resource* TSys::DeserializationArena::Resource()
+{
+    return &resource;
+}
+
+
+std::any TSys::DeserializationArena::DeserializeValue(const TypeHandler& handler, const std::any& v,
+                                                      rapidjson::Value& value)
+{
+    return handler.DeserializeValue(v, value, &resource);
+}
+
+
+std::any TSys::DeserializationArena::DeserializeConstruction(const TypeHandler& handler,
+                                                             rapidjson::Value& value)
+{
+    return handler.DeserializeConstruction(value, &resource);
+}
+
+
+void TSys::DeserializationArena::Release()
+{
+    // Document must go before the allocator it uses, both before
+    // the blocks backing them.
+    if (document)
+    {
+        std::destroy_at(document);
+        document = nullptr;
+    }
+
+    if (allocator)
+    {
+        std::destroy_at(allocator);
+        allocator = nullptr;
+    }
+
+    resource.release();
+}
@@ -0,0 +1,578 @@
+#include "include/batchKernels.h"
+
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TSYS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TSYS_TARGET(isa)
+#else
+#define TSYS_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+
+namespace
+{
+    template<typename From, typename To>
+    using KernelFunction = void (*)(const From*, To*, size_t);
+
+
+    template<typename From, typename To>
+    void Scalar(const From* sources, To* results, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            results[i] = static_cast<To>(sources[i]);
+        }
+    }
+
+
+    // Returns kernel of level, missing levels fall back to the
+    // level below.
+    template<typename From, typename To>
+    KernelFunction<From, To> SelectKernel(TSys::SimdLevel level,
+                                          KernelFunction<From, To> sse2,
+                                          KernelFunction<From, To> avx2,
+                                          KernelFunction<From, To> avx512)
+    {
+        switch (level)
+        {
+            case TSys::SimdLevel::AVX512:
+                if (avx512)
+                    return avx512;
+                [[fallthrough]];
+            case TSys::SimdLevel::AVX2:
+                if (avx2)
+                    return avx2;
+                [[fallthrough]];
+            case TSys::SimdLevel::SSE2:
+                if (sse2)
+                    return sse2;
+                [[fallthrough]];
+            default:
+                return &Scalar<From, To>;
+        }
+    }
+
+
+#ifdef TSYS_X86
+    // SSE2
+    TSYS_TARGET("sse2")
+    void IntToFloatSSE2(const int* sources, float* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sources + i));
+            _mm_storeu_ps(results + i, _mm_cvtepi32_ps(v));
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("sse2")
+    void FloatToIntSSE2(const float* sources, int* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i v = _mm_cvttps_epi32(_mm_loadu_ps(sources + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(results + i), v);
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("sse2")
+    void IntToDoubleSSE2(const int* sources, double* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(sources + i));
+            _mm_storeu_pd(results + i, _mm_cvtepi32_pd(v));
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("sse2")
+    void DoubleToIntSSE2(const double* sources, int* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128i v = _mm_cvttpd_epi32(_mm_loadu_pd(sources + i));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(results + i), v);
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("sse2")
+    void FloatToDoubleSSE2(const float* sources, double* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 v = _mm_loadu_ps(sources + i);
+            _mm_storeu_pd(results + i, _mm_cvtps_pd(v));
+            _mm_storeu_pd(results + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("sse2")
+    void DoubleToFloatSSE2(const double* sources, float* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 low = _mm_cvtpd_ps(_mm_loadu_pd(sources + i));
+            __m128 high = _mm_cvtpd_ps(_mm_loadu_pd(sources + i + 2));
+            _mm_storeu_ps(results + i, _mm_movelh_ps(low, high));
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    // Packs four vectors of 32 bits all-ones / zero masks into
+    // sixteen 0 / 1 bools.
+    TSYS_TARGET("sse2")
+    inline void StoreMasksAsBools(__m128i m0, __m128i m1, __m128i m2, __m128i m3, bool* results)
+    {
+        __m128i packed = _mm_packs_epi16(_mm_packs_epi32(m0, m1),
+                                         _mm_packs_epi32(m2, m3));
+
+        packed = _mm_and_si128(packed, _mm_set1_epi8(1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(results), packed);
+    }
+
+
+    TSYS_TARGET("sse2")
+    void IntToBoolSSE2(const int* sources, bool* results, size_t count)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ones = _mm_set1_epi32(-1);
+
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i m[4];
+            for (int j = 0; j < 4; j++)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sources + i + 4 * j));
+                m[j] = _mm_xor_si128(_mm_cmpeq_epi32(v, zero), ones);
+            }
+
+            StoreMasksAsBools(m[0], m[1], m[2], m[3], results + i);
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("sse2")
+    void FloatToBoolSSE2(const float* sources, bool* results, size_t count)
+    {
+        // cmpneq is unordered, NaN gives true like static_cast.
+        const __m128 zero = _mm_setzero_ps();
+
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i m[4];
+            for (int j = 0; j < 4; j++)
+            {
+                __m128 v = _mm_loadu_ps(sources + i + 4 * j);
+                m[j] = _mm_castps_si128(_mm_cmpneq_ps(v, zero));
+            }
+
+            StoreMasksAsBools(m[0], m[1], m[2], m[3], results + i);
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("sse2")
+    void DoubleToBoolSSE2(const double* sources, bool* results, size_t count)
+    {
+        const __m128d zero = _mm_setzero_pd();
+
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i m[4];
+            for (int j = 0; j < 4; j++)
+            {
+                __m128d low = _mm_cmpneq_pd(_mm_loadu_pd(sources + i + 4 * j), zero);
+                __m128d high = _mm_cmpneq_pd(_mm_loadu_pd(sources + i + 4 * j + 2), zero);
+
+                // Keep one 32 bits half of each 64 bits mask.
+                m[j] = _mm_castps_si128(_mm_shuffle_ps(_mm_castpd_ps(low), _mm_castpd_ps(high),
+                                                       _MM_SHUFFLE(2, 0, 2, 0)));
+            }
+
+            StoreMasksAsBools(m[0], m[1], m[2], m[3], results + i);
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    // Widens sixteen bools to four vectors of 32 bits integers.
+    TSYS_TARGET("sse2")
+    inline void LoadBoolsAsInts(const bool* sources, __m128i* ints)
+    {
+        const __m128i zero = _mm_setzero_si128();
+
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sources));
+        __m128i low = _mm_unpacklo_epi8(bytes, zero);
+        __m128i high = _mm_unpackhi_epi8(bytes, zero);
+
+        ints[0] = _mm_unpacklo_epi16(low, zero);
+        ints[1] = _mm_unpackhi_epi16(low, zero);
+        ints[2] = _mm_unpacklo_epi16(high, zero);
+        ints[3] = _mm_unpackhi_epi16(high, zero);
+    }
+
+
+    TSYS_TARGET("sse2")
+    void BoolToIntSSE2(const bool* sources, int* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i ints[4];
+            LoadBoolsAsInts(sources + i, ints);
+
+            for (int j = 0; j < 4; j++)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(results + i + 4 * j), ints[j]);
+            }
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("sse2")
+    void BoolToFloatSSE2(const bool* sources, float* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i ints[4];
+            LoadBoolsAsInts(sources + i, ints);
+
+            for (int j = 0; j < 4; j++)
+            {
+                _mm_storeu_ps(results + i + 4 * j, _mm_cvtepi32_ps(ints[j]));
+            }
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("sse2")
+    void BoolToDoubleSSE2(const bool* sources, double* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i ints[4];
+            LoadBoolsAsInts(sources + i, ints);
+
+            for (int j = 0; j < 4; j++)
+            {
+                _mm_storeu_pd(results + i + 4 * j, _mm_cvtepi32_pd(ints[j]));
+                _mm_storeu_pd(results + i + 4 * j + 2, _mm_cvtepi32_pd(_mm_srli_si128(ints[j], 8)));
+            }
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    // AVX2
+    TSYS_TARGET("avx2")
+    void IntToFloatAVX2(const int* sources, float* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sources + i));
+            _mm256_storeu_ps(results + i, _mm256_cvtepi32_ps(v));
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("avx2")
+    void FloatToIntAVX2(const float* sources, int* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i v = _mm256_cvttps_epi32(_mm256_loadu_ps(sources + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(results + i), v);
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("avx2")
+    void IntToDoubleAVX2(const int* sources, double* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sources + i));
+            _mm256_storeu_pd(results + i, _mm256_cvtepi32_pd(v));
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("avx2")
+    void DoubleToIntAVX2(const double* sources, int* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i v = _mm256_cvttpd_epi32(_mm256_loadu_pd(sources + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(results + i), v);
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("avx2")
+    void FloatToDoubleAVX2(const float* sources, double* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm256_storeu_pd(results + i, _mm256_cvtps_pd(_mm_loadu_ps(sources + i)));
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("avx2")
+    void DoubleToFloatAVX2(const double* sources, float* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm_storeu_ps(results + i, _mm256_cvtpd_ps(_mm256_loadu_pd(sources + i)));
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    // AVX-512
+    TSYS_TARGET("avx512f")
+    void IntToFloatAVX512(const int* sources, float* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m512i v = _mm512_loadu_si512(sources + i);
+            _mm512_storeu_ps(results + i, _mm512_cvtepi32_ps(v));
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("avx512f")
+    void FloatToIntAVX512(const float* sources, int* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            _mm512_storeu_si512(results + i, _mm512_cvttps_epi32(_mm512_loadu_ps(sources + i)));
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("avx512f")
+    void IntToDoubleAVX512(const int* sources, double* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sources + i));
+            _mm512_storeu_pd(results + i, _mm512_cvtepi32_pd(v));
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("avx512f")
+    void DoubleToIntAVX512(const double* sources, int* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i v = _mm512_cvttpd_epi32(_mm512_loadu_pd(sources + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(results + i), v);
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("avx512f")
+    void FloatToDoubleAVX512(const float* sources, double* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            _mm512_storeu_pd(results + i, _mm512_cvtps_pd(_mm256_loadu_ps(sources + i)));
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSYS_TARGET("avx512f")
+    void DoubleToFloatAVX512(const double* sources, float* results, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            _mm256_storeu_ps(results + i, _mm512_cvtpd_ps(_mm512_loadu_pd(sources + i)));
+        }
+
+        Scalar(sources + i, results + i, count - i);
+    }
+
+
+    TSys::SimdLevel Detect()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+
+        __cpuid(info, 1);
+        bool sse2 = (info[3] & (1 << 26)) != 0;
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (!sse2)
+            return TSys::SimdLevel::Scalar;
+
+        if (!osxsave || maxLeaf < 7)
+            return TSys::SimdLevel::SSE2;
+
+        // Os must save the extended registers.
+        unsigned long long xcr0 = _xgetbv(0);
+        bool avxState = (xcr0 & 0x6) == 0x6;
+        bool avx512State = (xcr0 & 0xe6) == 0xe6;
+
+        __cpuidex(info, 7, 0);
+        bool avx2 = (info[1] & (1 << 5)) != 0;
+        bool avx512 = (info[1] & (1 << 16)) != 0;
+
+        if (avx512 && avx512State)
+            return TSys::SimdLevel::AVX512;
+
+        if (avx2 && avxState)
+            return TSys::SimdLevel::AVX2;
+
+        return TSys::SimdLevel::SSE2;
+#else
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx512f"))
+            return TSys::SimdLevel::AVX512;
+
+        if (__builtin_cpu_supports("avx2"))
+            return TSys::SimdLevel::AVX2;
+
+        if (__builtin_cpu_supports("sse2"))
+            return TSys::SimdLevel::SSE2;
+
+        return TSys::SimdLevel::Scalar;
+#endif
+    }
+#else
+    TSys::SimdLevel Detect()
+    {
+        return TSys::SimdLevel::Scalar;
+    }
+#endif
+}
+
+
+TSys::SimdLevel TSys::DetectedSimdLevel()
+{
+    static const SimdLevel level = Detect();
+
+    return level;
+}
+
+
+#ifdef TSYS_X86
+#define TSYS_KERNELS(sse2, avx2, avx512) sse2, avx2, avx512
+#else
+#define TSYS_KERNELS(sse2, avx2, avx512) nullptr, nullptr, nullptr
+#endif
+
+#define TSYS_DEFINE_BATCH_KERNEL(From, To, sse2, avx2, avx512)                          \
+void TSys::BatchKernel<From, To>::Run(const From* sources, To* results, size_t count)   \
+{                                                                                       \
+    static const KernelFunction<From, To> kernel = SelectKernel<From, To>(              \
+            DetectedSimdLevel(), TSYS_KERNELS(sse2, avx2, avx512));                     \
+                                                                                        \
+    kernel(sources, results, count);                                                    \
+}                                                                                       \
+                                                                                        \
+bool TSys::BatchKernel<From, To>::RunAt(SimdLevel level, const From* sources,           \
+                                        To* results, size_t count)                      \
+{                                                                                       \
+    if (level > DetectedSimdLevel())                                                    \
+        return false;                                                                   \
+                                                                                        \
+    SelectKernel<From, To>(level, TSYS_KERNELS(sse2, avx2, avx512))(                    \
+            sources, results, count);                                                   \
+    return true;                                                                        \
+}
+
+TSYS_DEFINE_BATCH_KERNEL(int, float, IntToFloatSSE2, IntToFloatAVX2, IntToFloatAVX512)
+TSYS_DEFINE_BATCH_KERNEL(int, double, IntToDoubleSSE2, IntToDoubleAVX2, IntToDoubleAVX512)
+TSYS_DEFINE_BATCH_KERNEL(int, bool, IntToBoolSSE2, nullptr, nullptr)
+TSYS_DEFINE_BATCH_KERNEL(float, int, FloatToIntSSE2, FloatToIntAVX2, FloatToIntAVX512)
+TSYS_DEFINE_BATCH_KERNEL(float, double, FloatToDoubleSSE2, FloatToDoubleAVX2, FloatToDoubleAVX512)
+TSYS_DEFINE_BATCH_KERNEL(float, bool, FloatToBoolSSE2, nullptr, nullptr)
+TSYS_DEFINE_BATCH_KERNEL(double, int, DoubleToIntSSE2, DoubleToIntAVX2, DoubleToIntAVX512)
+TSYS_DEFINE_BATCH_KERNEL(double, float, DoubleToFloatSSE2, DoubleToFloatAVX2, DoubleToFloatAVX512)
+TSYS_DEFINE_BATCH_KERNEL(double, bool, DoubleToBoolSSE2, nullptr, nullptr)
+TSYS_DEFINE_BATCH_KERNEL(bool, int, BoolToIntSSE2, nullptr, nullptr)
+TSYS_DEFINE_BATCH_KERNEL(bool, float, BoolToFloatSSE2, nullptr, nullptr)
+TSYS_DEFINE_BATCH_KERNEL(bool, double, BoolToDoubleSSE2, nullptr, nullptr)
+
+#undef TSYS_DEFINE_BATCH_KERNEL
+#undef TSYS_KERNELS
@@ -0,0 +1,359 @@
+#include "include/binary.h"
+
+#include <cstring>
+
+
+TSys::BinaryWriter::BinaryWriter(std::string& out): BinaryWriter(out, true)
+{
+
+}
+
+
+TSys::BinaryWriter::BinaryWriter(std::string& out, bool header): output(out)
+{
+    if (header)
+    {
+        output.append(Binary::Magic, sizeof(Binary::Magic));
+        output.push_back((char)Binary::Version);
+    }
+}
+
+
+void TSys::BinaryWriter::Put(Binary::Tag tag)
+{
+    output.push_back((char)tag);
+}
+
+
+void TSys::BinaryWriter::PutVarint(uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        output.push_back((char)((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+
+    output.push_back((char)v);
+}
+
+
+void TSys::BinaryWriter::PutFixed(uint64_t v, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        output.push_back((char)(v >> (8 * i)));
+    }
+}
+
+
+void TSys::BinaryWriter::PutBytes(const Ch* str, size_t length)
+{
+    PutVarint(length);
+    output.append(str, length);
+}
+
+
+bool TSys::BinaryWriter::Null()
+{
+    Put(Binary::Tag::Null);
+    return true;
+}
+
+
+bool TSys::BinaryWriter::Bool(bool b)
+{
+    Put(b ? Binary::Tag::True : Binary::Tag::False);
+    return true;
+}
+
+
+bool TSys::BinaryWriter::Int(int i)
+{
+    Put(Binary::Tag::Int);
+    PutFixed((uint32_t)i, 4);
+    return true;
+}
+
+
+bool TSys::BinaryWriter::Uint(unsigned u)
+{
+    Put(Binary::Tag::Uint);
+    PutFixed(u, 4);
+    return true;
+}
+
+
+bool TSys::BinaryWriter::Int64(int64_t i)
+{
+    Put(Binary::Tag::Int64);
+    PutFixed((uint64_t)i, 8);
+    return true;
+}
+
+
+bool TSys::BinaryWriter::Uint64(uint64_t u)
+{
+    Put(Binary::Tag::Uint64);
+    PutFixed(u, 8);
+    return true;
+}
+
+
+bool TSys::BinaryWriter::Double(double d)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+
+    Put(Binary::Tag::Double);
+    PutFixed(bits, 8);
+    return true;
+}
+
+
+bool TSys::BinaryWriter::RawNumber(const Ch* str, rapidjson::SizeType length, bool copy)
+{
+    Put(Binary::Tag::RawNumber);
+    PutBytes(str, length);
+    return true;
+}
+
+
+bool TSys::BinaryWriter::String(const Ch* str, rapidjson::SizeType length, bool copy)
+{
+    Put(Binary::Tag::String);
+    PutBytes(str, length);
+    return true;
+}
+
+
+bool TSys::BinaryWriter::StartObject()
+{
+    Put(Binary::Tag::StartObject);
+    return true;
+}
+
+
+bool TSys::BinaryWriter::Key(const Ch* str, rapidjson::SizeType length, bool copy)
+{
+    Put(Binary::Tag::Key);
+    PutBytes(str, length);
+    return true;
+}
+
+
+bool TSys::BinaryWriter::EndObject(rapidjson::SizeType memberCount)
+{
+    Put(Binary::Tag::EndObject);
+    return true;
+}
+
+
+bool TSys::BinaryWriter::StartArray()
+{
+    Put(Binary::Tag::StartArray);
+    return true;
+}
+
+
+bool TSys::BinaryWriter::EndArray(rapidjson::SizeType elementCount)
+{
+    Put(Binary::Tag::EndArray);
+    return true;
+}
+
+
+bool TSys::BinaryWriter::TypeName(const std::string& name)
+{
+    auto iter = typeIds.find(name);
+    if (iter != typeIds.end())
+    {
+        Put(Binary::Tag::TypeReference);
+        PutVarint(iter->second);
+        return true;
+    }
+
+    // First occurrence, defines next id.
+    typeIds.emplace(name, (uint32_t)typeIds.size());
+
+    Put(Binary::Tag::TypeDefinition);
+    PutBytes(name.c_str(), name.size());
+    return true;
+}
+
+
+TSys::BinaryReader::BinaryReader(const char* data, size_t size)
+{
+    cursor = data;
+    end = data + size;
+}
+
+
+TSys::BinaryReader::BinaryReader(std::string_view data):
+    BinaryReader(data.data(), data.size())
+{
+
+}
+
+
+bool TSys::BinaryReader::GetVarint(uint64_t& v)
+{
+    v = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7)
+    {
+        if (cursor == end)
+        {
+            return false;
+        }
+
+        auto byte = (uint8_t)*cursor++;
+        v |= (uint64_t)(byte & 0x7f) << shift;
+
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool TSys::BinaryReader::GetFixed(uint64_t& v, size_t size)
+{
+    if ((size_t)(end - cursor) < size)
+    {
+        return false;
+    }
+
+    v = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        v |= (uint64_t)(uint8_t)cursor[i] << (8 * i);
+    }
+
+    cursor += size;
+    return true;
+}
+
+
+bool TSys::BinaryReader::GetBytes(std::string_view& bytes)
+{
+    uint64_t length;
+    if (!GetVarint(length) || (uint64_t)(end - cursor) < length)
+    {
+        return false;
+    }
+
+    bytes = std::string_view(cursor, (size_t)length);
+    cursor += length;
+    return true;
+}
+
+
+bool TSys::BinaryReader::Read()
+{
+    if (!headerRead)
+    {
+        if ((size_t)(end - cursor) < sizeof(Binary::Magic) + 1 ||
+            std::memcmp(cursor, Binary::Magic, sizeof(Binary::Magic)) != 0 ||
+            (uint8_t)cursor[sizeof(Binary::Magic)] != Binary::Version)
+        {
+            return false;
+        }
+
+        cursor += sizeof(Binary::Magic) + 1;
+        headerRead = true;
+    }
+
+    // Input complete.
+    if (cursor == end)
+    {
+        return true;
+    }
+
+    auto tag = (Binary::Tag)*cursor++;
+
+    uint64_t v;
+    std::string_view bytes;
+
+    switch (tag)
+    {
+        case Binary::Tag::Null:
+            return Null();
+
+        case Binary::Tag::False:
+            return Bool(false);
+
+        case Binary::Tag::True:
+            return Bool(true);
+
+        case Binary::Tag::Int:
+            return GetFixed(v, 4) && Int((int32_t)(uint32_t)v);
+
+        case Binary::Tag::Uint:
+            return GetFixed(v, 4) && Uint((uint32_t)v);
+
+        case Binary::Tag::Int64:
+            return GetFixed(v, 8) && Int64((int64_t)v);
+
+        case Binary::Tag::Uint64:
+            return GetFixed(v, 8) && Uint64(v);
+
+        case Binary::Tag::Double:
+        {
+            if (!GetFixed(v, 8))
+            {
+                return false;
+            }
+
+            double d;
+            std::memcpy(&d, &v, sizeof(d));
+            return Double(d);
+        }
+
+        case Binary::Tag::String:
+            return GetBytes(bytes) &&
+                   Reference(Token::String, bytes.data(), (rapidjson::SizeType)bytes.size());
+
+        case Binary::Tag::RawNumber:
+            return GetBytes(bytes) &&
+                   RawNumber(bytes.data(), (rapidjson::SizeType)bytes.size(), true);
+
+        case Binary::Tag::Key:
+            return GetBytes(bytes) &&
+                   Reference(Token::Key, bytes.data(), (rapidjson::SizeType)bytes.size());
+
+        case Binary::Tag::StartObject:
+            return StartObject();
+
+        case Binary::Tag::EndObject:
+            return EndObject(0);
+
+        case Binary::Tag::StartArray:
+            return StartArray();
+
+        case Binary::Tag::EndArray:
+            return EndArray(0);
+
+        case Binary::Tag::TypeDefinition:
+            if (!GetBytes(bytes))
+            {
+                return false;
+            }
+
+            typeNames.push_back(bytes);
+            return Reference(Token::String, bytes.data(), (rapidjson::SizeType)bytes.size());
+
+        case Binary::Tag::TypeReference:
+            if (!GetVarint(v) || v >= typeNames.size())
+            {
+                return false;
+            }
+
+            bytes = typeNames[(size_t)v];
+            return Reference(Token::String, bytes.data(), (rapidjson::SizeType)bytes.size());
+
+        default:
+            return false;
+    }
+}
@@ -6,740 +6,2064 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <memory_resource>
+#include <cctype>
+#include <algorithm>
+#include <stdexcept>
+#include <charconv>
+#include <system_error>
+#include <type_traits>
+#include <cstring>
+#include <cstdint>
 #include "rapidjson/reader.h"
 #include "rapidjson/document.h"
 
 
-TSys::Enum::Enum()
+// Boost hash_combine.
+static void CombineHash(size_t& seed, size_t hash)
 {
-    currentIndex = 0;
+    seed ^= hash + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 }
 
 
-TSys::Enum::Enum(const Enum& other)
+// Appends construction type name to json construction array.
+static void SerializeTypeName(const std::string& name, rapidjson::Value& value,
+                              rapidjson::Document& doc)
 {
-    values = other.values;
-    currentIndex = other.currentIndex;
+    value.PushBack(
+            rapidjson::Value().SetString(
+                    name.c_str(), (rapidjson::SizeType)name.size(),
+                    doc.GetAllocator()
+            ),
+            doc.GetAllocator()
+    );
 }
 
 
-TSys::Enum::Enum(const std::map<unsigned int, std::string>& v)
+void TSys::EnumDefinition::BuildIndex()
 {
-    values = v;
-    currentIndex = 0;
+    names.clear();
+    names.reserve(values.size());
+
+    hash = values.size();
+    dense = true;
+
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        const auto& entry = values[i];
+        names.emplace(entry.second, entry.first);
+
+        dense = dense && entry.first == i;
+
+        CombineHash(hash, entry.first);
+        CombineHash(hash, std::hash<std::string_view>{}(entry.second));
+    }
 }
 
 
-TSys::Enum::Enum(const std::map<unsigned int, std::string>& v, unsigned int i)
+TSys::EnumDefinition::EnumDefinition()
 {
-    values = v;
-    currentIndex = i;
+    BuildIndex();
 }
 
 
-TSys::Enum::Enum(const std::vector<std::string>& v) {
-    for (unsigned int i = 0; i < v.size(); i++) {
-        values[i] = v[i];
-    }
-
-    currentIndex = 0;
+TSys::EnumDefinition::EnumDefinition(const EnumDefinition& other): values(other.values)
+{
+    BuildIndex();
 }
 
 
-TSys::Enum::Enum(const std::vector<std::string>& v, unsigned int i)
+TSys::EnumDefinition& TSys::EnumDefinition::operator=(const EnumDefinition& other)
 {
-    for (unsigned int u = 0; u < v.size(); u++)
+    if (this != &other)
     {
-        values[u] = v[u];
+        values = other.values;
+        BuildIndex();
     }
 
-    currentIndex = i;
+    return *this;
 }
 
 
-std::string TSys::Enum::CurrentValue() const
+TSys::EnumDefinition::EnumDefinition(std::pmr::vector<Entry> v):
+    values(std::move(v)),
+    names(values.get_allocator())
 {
-    if (values.find(currentIndex) == values.end())
+    // Entries read back from documents are usually in order already,
+    // which skips the buffer stable_sort takes from the global heap.
+    auto unordered = std::adjacent_find(values.begin(), values.end(),
+                                        [](const Entry& e1, const Entry& e2) { return e1.first >= e2.first; });
+    if (unordered == values.end())
     {
-        return "";
+        BuildIndex();
+        return;
+    }
+
+    // Stable, so that last of duplicated indices is kept below.
+    std::stable_sort(values.begin(), values.end(),
+                     [](const Entry& e1, const Entry& e2) { return e1.first < e2.first; });
+
+    auto last = values.end();
+    for (auto iter = values.begin(); iter != values.end(); ++iter)
+    {
+        if (last != values.end() && last->first == iter->first)
+        {
+            *last = std::move(*iter);
+            continue;
+        }
+
+        last = (last == values.end()) ? values.begin() : last + 1;
+        if (last != iter)
+        {
+            *last = std::move(*iter);
+        }
     }
 
-    return values.at(currentIndex);
+    if (last != values.end())
+    {
+        values.erase(last + 1, values.end());
+    }
+
+    BuildIndex();
 }
 
 
-unsigned int TSys::Enum::CurrentIndex() const
+TSys::EnumDefinition::EnumDefinition(const std::map<unsigned int, std::string>& v)
 {
-    return currentIndex;
+    values.assign(v.begin(), v.end());
+    BuildIndex();
 }
 
 
-bool TSys::Enum::SetCurrentIndex(unsigned int index)
+TSys::EnumDefinition::EnumDefinition(const std::vector<std::string>& v)
 {
-    if (values.find(index) == values.end())
+    values.reserve(v.size());
+    for (unsigned int i = 0; i < v.size(); i++)
     {
-        return false;
+        values.emplace_back(i, v[i]);
     }
 
-    currentIndex = index;
-    return true;
+    BuildIndex();
 }
 
 
-bool TSys::Enum::SetCurrentValue(std::string value)
+const std::pmr::vector<TSys::EnumDefinition::Entry>& TSys::EnumDefinition::Values() const
 {
-    for (std::pair<int, std::string> p : values)
-    {
-        if (p.second == value)
-        {
-            SetCurrentIndex(p.first);
-            return true;
-        }
-    }
+    return values;
+}
 
-    return false;
+
+size_t TSys::EnumDefinition::Size() const
+{
+    return values.size();
 }
 
 
-void TSys::Enum::AddValue(int index, std::string value)
+const TSys::EnumDefinition::Entry* TSys::EnumDefinition::Find(unsigned int index) const
 {
-    values[index] = value;
+    size_t position = Position(index);
+    if (position == values.size())
+    {
+        return nullptr;
+    }
+
+    return &values[position];
 }
 
 
-std::vector<int> TSys::Enum::Indices()
+const TSys::EnumDefinition::Entry* TSys::EnumDefinition::Find(std::string_view name) const
 {
-    std::vector<int> v;
-    for (std::pair<int, std::string> p : values)
+    auto iter = names.find(name);
+    if (iter == names.end())
     {
-        v.push_back(p.first);
+        return nullptr;
     }
 
-    return v;
+    return Find(iter->second);
 }
 
-std::string TSys::Enum::ValueAtIndex(int index)
+
+size_t TSys::EnumDefinition::Position(unsigned int index) const
 {
-    return values.at(index);
+    if (dense)
+    {
+        return index < values.size() ? index : values.size();
+    }
+
+    auto iter = std::lower_bound(values.begin(), values.end(), index,
+                                 [](const Entry& e, unsigned int i) { return e.first < i; });
+
+    if (iter == values.end() || iter->first != index)
+    {
+        return values.size();
+    }
+
+    return iter - values.begin();
 }
 
 
-bool TSys::Enum::operator==(const Enum& other) const
+size_t TSys::EnumDefinition::Hash() const
 {
-    return (CurrentValue() == other.CurrentValue());
+    return hash;
 }
 
 
-bool TSys::Enum::operator==(const Enum* other) const
+bool TSys::EnumDefinition::operator==(const EnumDefinition& other) const
 {
-    return (CurrentValue() == other->CurrentValue());
+    return hash == other.hash && values == other.values;
 }
 
 
-// Invalid Any Cast.
-size_t TSys::InvalidAnyCast::Hash()
+bool TSys::EnumDefinition::operator<(const EnumDefinition& other) const
 {
-    return typeid(InvalidAnyCast).hash_code();
+    return values < other.values;
 }
 
 
-bool TSys::InvalidAnyCast::IsInvalid(const std::any& other)
+static const TSys::EnumDefinitionPtr& EmptyDefinition()
 {
-    return (other.type().hash_code() == Hash());
+    static const TSys::EnumDefinitionPtr empty = std::make_shared<const TSys::EnumDefinition>();
+    return empty;
 }
 
 
-bool TSys::InvalidAnyCast::IsValid(const std::any& other)
+TSys::Enum::Enum(): definition(EmptyDefinition())
 {
-    return (!IsInvalid(other));
+    currentIndex = 0;
 }
 
 
-// Any value
-TSys::AnyValue::AnyValue(std::any v)
+TSys::Enum::Enum(EnumDefinitionPtr d, unsigned int i): definition(std::move(d))
 {
-    value = std::move(v);
+    if (!definition)
+    {
+        definition = EmptyDefinition();
+    }
+
+    currentIndex = i;
 }
 
 
-void TSys::AnyValue::SetInput(const std::any& val)
+TSys::Enum::Enum(const std::map<unsigned int, std::string>& v):
+    Enum(std::make_shared<const EnumDefinition>(v))
 {
-    value = val;
+
 }
 
 
-size_t TSys::AnyValue::Hash() const
+TSys::Enum::Enum(const std::map<unsigned int, std::string>& v, unsigned int i):
+    Enum(std::make_shared<const EnumDefinition>(v), i)
 {
-    return value.type().hash_code();
+
 }
 
 
-std::string TSys::AnyValue::Name() const
+TSys::Enum::Enum(const std::vector<std::string>& v):
+    Enum(std::make_shared<const EnumDefinition>(v))
 {
-    return value.type().name();
+
 }
 
 
-std::any TSys::AnyValue::InputValue() const
+TSys::Enum::Enum(const std::vector<std::string>& v, unsigned int i):
+    Enum(std::make_shared<const EnumDefinition>(v), i)
 {
-    return value;
+
 }
 
-boost::python::object TSys::AnyValue::Python_Get()
+
+std::string TSys::Enum::CurrentValue() const
 {
-    auto handler = TypeRegistry::GetRegistry()->GetTypeHandle(Hash());
-    if (!handler)
+    auto entry = definition->Find(currentIndex);
+    if (!entry)
     {
-        return {};
+        return "";
     }
 
-    return handler->ToPython(value);
+    return std::string(entry->second);
 }
 
-bool TSys::AnyValue::Python_Set(boost::python::object val)
+
+unsigned int TSys::Enum::CurrentIndex() const
 {
-    auto handler = TypeRegistry::GetRegistry()->GetTypeHandle(val);
-    if (!handler)
+    return currentIndex;
+}
+
+
+bool TSys::Enum::SetCurrentIndex(unsigned int index)
+{
+    if (!definition->Find(index))
     {
         return false;
     }
 
-    value = handler->FromPython(val);
+    currentIndex = index;
     return true;
 }
 
-std::any TSys::AnyValue::ConvertTo(size_t hash)
+
+bool TSys::Enum::SetCurrentValue(std::string value)
 {
-    if (hash == Hash())
+    auto entry = definition->Find(std::string_view(value));
+    if (!entry)
     {
-        return value;
+        return false;
     }
 
-    auto handler = TypeRegistry::GetRegistry()->GetTypeHandle(hash);
-    if (!handler)
-    {
-        return std::make_any<InvalidAnyCast>(InvalidAnyCast());
-    }
+    currentIndex = entry->first;
+    return true;
+}
+
+
+void TSys::Enum::AddValue(int index, std::string value)
+{
+    std::pmr::vector<EnumDefinition::Entry> values = definition->Values();
+    values.emplace_back(index, std::move(value));
 
-    return handler->ConvertFrom(value, value);
+    definition = std::make_shared<const EnumDefinition>(std::move(values));
 }
 
-bool  TSys::AnyValue::operator == (AnyValue& other)
+
+std::vector<int> TSys::Enum::Indices() const
 {
-    if (Hash() != other.Hash())
+    std::vector<int> v;
+    v.reserve(definition->Size());
+
+    for (const auto& entry : definition->Values())
     {
-        return false;
+        v.push_back(entry.first);
     }
 
-    auto handler = TypeRegistry::GetRegistry()->GetTypeHandle(Hash());
+    return v;
+}
 
-    if (!handler)
+std::string TSys::Enum::ValueAtIndex(int index) const
+{
+    auto entry = definition->Find(index);
+    if (!entry)
     {
-        return false;
+        throw std::out_of_range("Enum index out of range");
     }
 
-    return handler->CompareValue(value, other.InputValue());
+    return std::string(entry->second);
 }
 
-bool TSys::AnyValue::operator == (std::any& other)
+
+const TSys::EnumDefinitionPtr& TSys::Enum::Definition() const
 {
-    if (Hash() != other.type().hash_code())
-    {
-        return false;
-    }
+    return definition;
+}
 
-    auto handler = TypeRegistry::GetRegistry()->GetTypeHandle(Hash());
-    if (!handler)
+
+bool TSys::Enum::operator==(const Enum& other) const
+{
+    // Shared definition, same index names the same value.
+    if (definition == other.definition && currentIndex == other.currentIndex)
     {
-        return false;
+        return true;
     }
 
-    return handler->CompareValue(value, other);
+    auto entry = definition->Find(currentIndex);
+    auto otherEntry = other.definition->Find(other.currentIndex);
+
+    std::string_view value = entry ? std::string_view(entry->second) : std::string_view();
+    std::string_view otherValue = otherEntry ? std::string_view(otherEntry->second) : std::string_view();
+
+    return value == otherValue;
 }
 
 
-// String
-template<typename N>
-struct NumberToStr
+bool TSys::Enum::operator==(const Enum* other) const
 {
-    std::any operator()(const std::any& from, const std::any& to) const
-    {
-        N val = std::any_cast<N>(from);
-
-        try
-        {
-            std::string sval = std::to_string(val);
-            return std::make_any<std::string>(sval);
-        }
-        catch(...)
-        {
-            return {};
-        }
-    }
-};
+    return *this == *other;
+}
 
 
-template<typename C>
-struct CharTypeToStr
+TSys::EnumFlags::EnumFlags(): definition(EmptyDefinition())
 {
-    std::any operator()(const std::any& from, const std::any& to) const
-    {
-        return std::make_any<std::string>(
-                std::string(
-                        std::any_cast<C>(
-                                from
-                        )
-                )
-        );
-    }
-};
+
+}
 
 
-struct EnumToStr
+TSys::EnumFlags::EnumFlags(EnumDefinitionPtr d): definition(std::move(d))
 {
-    std::any operator()(const std::any& from, const std::any& to) const
+    if (!definition)
     {
-        auto enum_ = std::any_cast<TSys::Enum>(from);
-        return std::make_any<std::string>(enum_.CurrentValue());
+        definition = EmptyDefinition();
     }
-};
 
+    words.resize(WordCount() - 1, 0);
+}
 
 
-TSys::StringHandler::StringHandler()
+TSys::EnumFlags::EnumFlags(const Enum& en): EnumFlags(en.Definition())
 {
-    RegisterConverter<int, NumberToStr<int>>();
-    RegisterConverter<float>(NumberToStr<float>());
-    RegisterConverter<double, NumberToStr<double>>();
-    RegisterConverter<Enum, EnumToStr>();
-    RegisterConverter<AnyValue, AnyConverter>();
-    RegisterConverter<const char*, CharTypeToStr<const char*>>();
-    RegisterConverter<char*, CharTypeToStr<char*>>();
+    Set(en.CurrentIndex());
 }
 
 
-std::any TSys::StringHandler::InitValue() const
+TSys::EnumFlags::EnumFlags(const std::vector<std::string>& v):
+    EnumFlags(std::make_shared<const EnumDefinition>(v))
 {
-    return std::make_any<std::string>(std::string(""));
+
 }
 
 
-std::any TSys::StringHandler::CopyValue(const std::any& source) const
+uint64_t& TSys::EnumFlags::WordAt(size_t word)
 {
-    std::string value = std::string(std::any_cast<std::string>(source));
-
-    return std::make_any<std::string>(value);
+    return word ? words[word - 1] : bits;
 }
 
 
-std::string TSys::StringHandler::ApiName() const
+void TSys::EnumFlags::Trim()
 {
-    return "String";
+    size_t used = Size() % WordBits;
+    if (!Size())
+    {
+        bits = 0;
+    }
+    else if (used)
+    {
+        WordAt(WordCount() - 1) &= (uint64_t(1) << used) - 1;
+    }
 }
 
 
-std::any TSys::StringHandler::FromPython(const boost::python::object& obj) const
+const TSys::EnumFlags& TSys::EnumFlags::Aligned(const EnumFlags& other, EnumFlags& storage) const
 {
-    if (!PyUnicode_Check(obj.ptr()))
+    if (definition == other.definition || *definition == *other.definition)
     {
-        return std::make_any<std::string>("");
+        return other;
     }
 
-    std::string val = PyUnicode_AsUTF8(obj.ptr());
-    return std::make_any<std::string>(val);
+    storage = EnumFlags(definition);
+
+    const auto& values = other.definition->Values();
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if (other.TestPosition(i))
+        {
+            storage.SetValue(values[i].second);
+        }
+    }
+
+    return storage;
 }
 
 
-boost::python::object TSys::StringHandler::ToPython(const std::any& value) const
+const TSys::EnumDefinitionPtr& TSys::EnumFlags::Definition() const
 {
-    return boost::python::object(std::any_cast<std::string>(value));
+    return definition;
 }
 
 
-void TSys::StringHandler::SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
-                                         rapidjson::Document& doc) const
+size_t TSys::EnumFlags::Size() const
 {
-    rapidjson::Value stringValue(rapidjson::kStringType);
+    return definition->Size();
+}
 
-    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
 
-    jsonValue.PushBack(rapidjson::Value().SetString(
-                               vname.c_str(), (rapidjson::SizeType)vname.size(), doc.GetAllocator()),
-                       doc.GetAllocator());
+size_t TSys::EnumFlags::WordCount() const
+{
+    return std::max<size_t>(1, (Size() + WordBits - 1) / WordBits);
+}
 
-    std::string saveValue = std::any_cast<std::string>(v);
-    rapidjson::Value& _v = stringValue.SetString(
-            rapidjson::StringRef(saveValue.c_str(), (rapidjson::SizeType)saveValue.size()),
-            doc.GetAllocator());
 
-    jsonValue.PushBack(_v, doc.GetAllocator());
+uint64_t TSys::EnumFlags::Word(size_t word) const
+{
+    return word ? words[word - 1] : bits;
 }
 
 
-std::any TSys::StringHandler::DeserializeValue(const std::any&, rapidjson::Value& value) const
+void TSys::EnumFlags::SetWord(size_t word, uint64_t value)
 {
-    rapidjson::Value& result = value.GetArray()[1];
-    std::string res = result.GetString();
-    return std::make_any<std::string>(res);
+    WordAt(word) = value;
+    Trim();
 }
 
 
-void TSys::StringHandler::SerializeConstruction(const std::any& v, rapidjson::Value& value,
-                                                rapidjson::Document& doc) const
+bool TSys::EnumFlags::Set(unsigned int index, bool value)
 {
-    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
+    return SetPosition(definition->Position(index), value);
+}
 
-    // jsonValue.PushBack(rapidjson::StringRef(vname.c_str()), doc.GetAllocator());
-    value.PushBack(
-            rapidjson::Value().SetString(
-                    vname.c_str(), (rapidjson::SizeType)vname.size(),
-                    doc.GetAllocator()
-            ),
-            doc.GetAllocator()
-    );
+
+bool TSys::EnumFlags::Reset(unsigned int index)
+{
+    return Set(index, false);
 }
 
 
-std::any TSys::StringHandler::DeserializeConstruction(rapidjson::Value& value) const
+bool TSys::EnumFlags::Test(unsigned int index) const
 {
-    return InitValue();
+    return TestPosition(definition->Position(index));
 }
 
 
-// Bool
-struct StrToBool
+bool TSys::EnumFlags::SetValue(std::string_view name, bool value)
 {
-    std::any operator()(const std::any& from, const std::any& to) const
+    auto entry = definition->Find(name);
+    if (!entry)
     {
-        bool empty = std::any_cast<std::string>(from).empty();
-        return std::make_any<bool>(empty);
+        return false;
     }
-};
 
+    return SetPosition(entry - definition->Values().data(), value);
+}
 
-struct EnumToBool
+
+bool TSys::EnumFlags::TestValue(std::string_view name) const
 {
-    std::any operator()(const std::any& from, const std::any& to) const
+    auto entry = definition->Find(name);
+    if (!entry)
     {
-        return std::make_any<bool>(std::any_cast<TSys::Enum>(from).CurrentIndex());
+        return false;
     }
-};
+
+    return TestPosition(entry - definition->Values().data());
+}
 
 
-TSys::BoolHandler::BoolHandler(): TSys::GenericTypeHandler<bool>()
+bool TSys::EnumFlags::SetPosition(size_t position, bool value)
 {
-    RegisterConstructibleConverter<int>();
-    RegisterConstructibleConverter<float>();
-    RegisterConstructibleConverter<double>();
-    RegisterConverter<std::string, StrToBool>();
-    RegisterConverter<Enum, EnumToBool>();
-    RegisterConverter<AnyValue, AnyConverter>();
+    if (position >= Size())
+    {
+        return false;
+    }
+
+    uint64_t mask = uint64_t(1) << (position % WordBits);
+    uint64_t& word = WordAt(position / WordBits);
+
+    word = value ? word | mask : word & ~mask;
+    return true;
 }
 
 
-std::string TSys::BoolHandler::ApiName() const
+bool TSys::EnumFlags::TestPosition(size_t position) const
 {
-    return "Bool";
+    if (position >= Size())
+    {
+        return false;
+    }
+
+    return (Word(position / WordBits) >> (position % WordBits)) & 1;
 }
 
 
-std::any TSys::BoolHandler::InitValue() const
+void TSys::EnumFlags::Clear()
 {
-    return std::make_any<bool>(true);
+    bits = 0;
+    std::fill(words.begin(), words.end(), 0);
 }
 
 
-std::any TSys::BoolHandler::CopyValue(const std::any& source) const
+size_t TSys::EnumFlags::Count() const
 {
-    bool value = std::any_cast<bool>(source);
+    size_t count = 0;
+    for (size_t i = 0; i < WordCount(); i++)
+    {
+        for (uint64_t word = Word(i); word; word &= word - 1)
+        {
+            count++;
+        }
+    }
 
-    return std::make_any<bool>(value);
+    return count;
 }
 
 
-std::any TSys::BoolHandler::FromPython(const boost::python::object& obj) const
+bool TSys::EnumFlags::Any() const
 {
-    return ExtractPythonToAny<bool>(obj);
+    if (bits)
+    {
+        return true;
+    }
+
+    return std::any_of(words.begin(), words.end(), [](uint64_t w) { return w != 0; });
 }
 
 
-boost::python::object TSys::BoolHandler::ToPython(const std::any& value) const
+bool TSys::EnumFlags::None() const
 {
-    return boost::python::object(std::any_cast<bool>(value));
+    return !Any();
 }
 
 
-void TSys::BoolHandler::SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
-                                       rapidjson::Document& doc) const
+std::vector<unsigned int> TSys::EnumFlags::Indices() const
 {
-    bool success;
-    rapidjson::Value stringValue(rapidjson::kStringType);
+    std::vector<unsigned int> v;
 
-    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
+    const auto& values = definition->Values();
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if (TestPosition(i))
+        {
+            v.push_back(values[i].first);
+        }
+    }
 
-    jsonValue.PushBack(rapidjson::Value().SetString(
-                               vname.c_str(), (rapidjson::SizeType)vname.size(), doc.GetAllocator()),
-                       doc.GetAllocator());
+    return v;
+}
 
-    rapidjson::Value intValue;
-    bool saveValue = std::any_cast<bool>(v);
-    intValue.SetBool(saveValue);
 
-    jsonValue.PushBack<bool>(saveValue, doc.GetAllocator());
+std::vector<std::string> TSys::EnumFlags::Values() const
+{
+    std::vector<std::string> v;
+
+    const auto& values = definition->Values();
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if (TestPosition(i))
+        {
+            v.emplace_back(values[i].second);
+        }
+    }
+
+    return v;
 }
 
 
-std::any TSys::BoolHandler::DeserializeValue(const std::any&, rapidjson::Value& value) const
+size_t TSys::EnumFlags::Hash() const
 {
-    bool result = value.GetArray()[1].GetBool();
-    return std::make_any<bool>(result);
+    size_t hash = definition->Hash();
+    CombineHash(hash, std::hash<uint64_t>{}(bits));
+
+    for (uint64_t word : words)
+    {
+        CombineHash(hash, std::hash<uint64_t>{}(word));
+    }
+
+    return hash;
 }
 
 
-void TSys::BoolHandler::SerializeConstruction(const std::any& v, rapidjson::Value& value,
-                                              rapidjson::Document& doc) const
+TSys::EnumFlags& TSys::EnumFlags::operator|=(const EnumFlags& other)
 {
-    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
+    if (!Size())
+    {
+        return *this = other;
+    }
 
-    // jsonValue.PushBack(rapidjson::StringRef(vname.c_str()), doc.GetAllocator());
-    value.PushBack(
-            rapidjson::Value().SetString(
-                    vname.c_str(), (rapidjson::SizeType)vname.size(),
-                    doc.GetAllocator()
-            ),
-            doc.GetAllocator()
-    );
+    EnumFlags storage;
+    const EnumFlags& aligned = Aligned(other, storage);
+
+    bits |= aligned.bits;
+    for (size_t i = 0; i < words.size(); i++)
+    {
+        words[i] |= aligned.words[i];
+    }
+
+    return *this;
 }
 
 
-std::any TSys::BoolHandler::DeserializeConstruction(rapidjson::Value& value) const
+TSys::EnumFlags& TSys::EnumFlags::operator&=(const EnumFlags& other)
 {
-    return InitValue();
+    EnumFlags storage;
+    const EnumFlags& aligned = Aligned(other, storage);
+
+    bits &= aligned.bits;
+    for (size_t i = 0; i < words.size(); i++)
+    {
+        words[i] &= aligned.words[i];
+    }
+
+    return *this;
 }
 
 
-// Int
-struct StrToInt
+TSys::EnumFlags& TSys::EnumFlags::operator^=(const EnumFlags& other)
 {
-    std::any operator()(const std::any& from, const std::any& to) const
+    if (!Size())
     {
-        try
-        {
-            return std::make_any<int>(std::stoi(std::any_cast<std::string>(from)));
-        }
-        catch (...)
-        {
-            return 0;
-        }
+        return *this = other;
     }
-};
 
+    EnumFlags storage;
+    const EnumFlags& aligned = Aligned(other, storage);
 
-struct EnumToInt
-{
-    std::any operator()(const std::any& from, const std::any& to) const
+    bits ^= aligned.bits;
+    for (size_t i = 0; i < words.size(); i++)
     {
-        auto en = std::any_cast<TSys::Enum>(from);
-        return std::make_any<int>(en.CurrentIndex());
+        words[i] ^= aligned.words[i];
     }
-};
+
+    return *this;
+}
 
 
-TSys::IntHandler::IntHandler(): TSys::GenericTypeHandler<int>()
+TSys::EnumFlags TSys::EnumFlags::operator|(const EnumFlags& other) const
 {
-    RegisterConstructibleConverter<bool>();
-    RegisterConstructibleConverter<float>();
-    RegisterConstructibleConverter<double>();
-    RegisterConverter<std::string, StrToInt>();
-    RegisterConverter<Enum, EnumToInt>();
-    RegisterConverter<AnyValue, AnyConverter>();
+    EnumFlags result(*this);
+    return result |= other;
 }
 
 
-std::string TSys::IntHandler::ApiName() const
+TSys::EnumFlags TSys::EnumFlags::operator&(const EnumFlags& other) const
 {
-    return "Int";
+    EnumFlags result(*this);
+    return result &= other;
 }
 
 
-std::any TSys::IntHandler::InitValue() const
+TSys::EnumFlags TSys::EnumFlags::operator^(const EnumFlags& other) const
 {
-    return std::make_any<int>(0);
+    EnumFlags result(*this);
+    return result ^= other;
 }
 
 
-std::any TSys::IntHandler::CopyValue(const std::any& source) const
+bool TSys::EnumFlags::operator==(const EnumFlags& other) const
 {
-    int value = int(std::any_cast<int>(source));
+    EnumFlags storage;
+    const EnumFlags& aligned = Aligned(other, storage);
+
+    if (&aligned == &other)
+    {
+        return bits == other.bits && words == other.words;
+    }
 
-    return std::make_any<int>(value);
+    // Values of other missing from definition are dropped when aligned.
+    return bits == aligned.bits && words == aligned.words && Count() == other.Count();
 }
 
 
-std::any TSys::IntHandler::FromPython(const boost::python::object& obj) const
+bool TSys::EnumFlags::operator!=(const EnumFlags& other) const
 {
-    return ExtractPythonToAny<int>(obj);
+    return !(*this == other);
 }
 
 
-boost::python::object TSys::IntHandler::ToPython(const std::any& value) const
+static thread_local TSys::EnumSchemaTable* currentSchemaTable = nullptr;
+
+
+unsigned int TSys::EnumSchemaTable::Insert(const EnumDefinitionPtr& definition)
 {
-    return boost::python::object(std::any_cast<int>(value));
+    auto id = (unsigned int)definitions.size();
+
+    // Ids follow table order, even for duplicated definitions.
+    ids.emplace(definition.get(), id);
+    sharedIds.emplace(definition.get(), id);
+    definitions.push_back(definition);
+
+    return id;
 }
 
 
-void TSys::IntHandler::SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
-                                      rapidjson::Document& doc) const
+unsigned int TSys::EnumSchemaTable::Add(const Enum& en)
 {
-    rapidjson::Value stringValue(rapidjson::kStringType);
+    return Add(en.Definition());
+}
 
-    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
 
-    jsonValue.PushBack(rapidjson::Value().SetString(
-                               vname.c_str(), (rapidjson::SizeType)vname.size(), doc.GetAllocator()),
-                       doc.GetAllocator());
+unsigned int TSys::EnumSchemaTable::Add(const EnumDefinitionPtr& definition)
+{
+    auto shared = sharedIds.find(definition.get());
+    if (shared != sharedIds.end())
+    {
+        return shared->second;
+    }
 
-    rapidjson::Value intValue;
-    int saveValue = std::any_cast<int>(v);
-    intValue.SetInt(saveValue);
+    auto iter = ids.find(definition.get());
+    if (iter != ids.end())
+    {
+        sharedIds.emplace(definition.get(), iter->second);
+        aliases.push_back(definition);
+
+        return iter->second;
+    }
 
-    jsonValue.PushBack<int>(saveValue, doc.GetAllocator());
+    return Insert(definition);
 }
 
 
-std::any TSys::IntHandler::DeserializeValue(const std::any&, rapidjson::Value& value) const
+TSys::EnumDefinitionPtr TSys::EnumSchemaTable::Definition(unsigned int id) const
 {
-    int result = value.GetArray()[1].GetInt();
-    return std::make_any<int>(result);
+    if (id >= definitions.size())
+    {
+        return nullptr;
+    }
+
+    return definitions[id];
 }
 
 
-void TSys::IntHandler::SerializeConstruction(const std::any& v, rapidjson::Value& value,
-                                             rapidjson::Document& doc) const
+size_t TSys::EnumSchemaTable::Size() const
 {
-    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
-
-    // jsonValue.PushBack(rapidjson::StringRef(vname.c_str()), doc.GetAllocator());
-    value.PushBack(
-            rapidjson::Value().SetString(
-                    vname.c_str(), (rapidjson::SizeType)vname.size(),
-                    doc.GetAllocator()
-            ),
-            doc.GetAllocator()
-    );
+    return definitions.size();
 }
 
 
-std::any TSys::IntHandler::DeserializeConstruction(rapidjson::Value& value) const
+void TSys::EnumSchemaTable::Clear()
 {
-    return InitValue();
+    ids.clear();
+    sharedIds.clear();
+    definitions.clear();
+    aliases.clear();
 }
 
 
-// Float
-struct StrToFloat
+void TSys::EnumSchemaTable::Serialize(rapidjson::Value& value, rapidjson::Document& doc) const
 {
-    std::any operator()(const std::any& from, const std::any& to) const
+    value.SetArray();
+
+    for (const auto& definition : definitions)
     {
-        try
-        {
-            return std::make_any<float>(std::stof(std::any_cast<std::string>(from)));
-        }
-        catch (...)
+        rapidjson::Value array(rapidjson::kArrayType);
+        for (const auto& pair : definition->Values())
         {
-            return 0.0f;
+            array.PushBack(rapidjson::Value().SetInt((int)pair.first), doc.GetAllocator());
+            array.PushBack(rapidjson::Value().SetString(
+                                   pair.second.c_str(), (rapidjson::SizeType)pair.second.size(),
+                                   doc.GetAllocator()),
+                           doc.GetAllocator());
         }
+
+        value.PushBack(array, doc.GetAllocator());
     }
-};
+}
 
 
-struct EnumToFloat
+bool TSys::EnumSchemaTable::Deserialize(const rapidjson::Value& value)
 {
-    std::any operator()(const std::any& from, const std::any& to) const
+    Clear();
+
+    if (!value.IsArray())
     {
-        auto en = std::any_cast<TSys::Enum>(from);
-        return std::make_any<float>((float)en.CurrentIndex());
+        return false;
     }
-};
 
+    for (const auto& array : value.GetArray())
+    {
+        if (!array.IsArray() || array.Size() % 2)
+        {
+            Clear();
+            return false;
+        }
+
+        std::pmr::vector<EnumDefinition::Entry> entries;
+        entries.reserve(array.Size() / 2);
 
-TSys::FloatHandler::FloatHandler(): TSys::GenericTypeHandler<float>()
-{
-    RegisterConstructibleConverter<bool>();
-    RegisterConstructibleConverter<int>();
-    RegisterConstructibleConverter<double>();
-    RegisterConverter<std::string, StrToFloat>();
-    RegisterConverter<Enum, EnumToFloat>();
-    RegisterConverter<AnyValue, AnyConverter>();
+        for (rapidjson::SizeType i = 0; i < array.Size(); i += 2)
+        {
+            if (!array[i].IsInt() || !array[i + 1].IsString())
+            {
+                Clear();
+                return false;
+            }
+
+            entries.emplace_back(array[i].GetInt(), TypedHandle<std::string>::Deserialize(array[i + 1]));
+        }
+
+        Insert(std::make_shared<const EnumDefinition>(std::move(entries)));
+    }
+
+    return true;
 }
 
 
-std::any TSys::FloatHandler::InitValue() const
+void TSys::EnumSchemaTable::Write(JsonWriter& writer) const
 {
-    return std::make_any<float>(0.0f);
+    writer.StartArray();
+
+    for (const auto& definition : definitions)
+    {
+        writer.StartArray();
+        for (const auto& pair : definition->Values())
+        {
+            writer.Int((int)pair.first);
+            writer.String(pair.second);
+        }
+
+        writer.EndArray(0);
+    }
+
+    writer.EndArray(0);
 }
 
 
-std::any TSys::FloatHandler::CopyValue(const std::any& source) const
+bool TSys::EnumSchemaTable::Read(JsonReader& reader)
 {
-    float value = float(std::any_cast<float>(source));
+    Clear();
+
+    if (!reader.Consume(JsonReader::Token::StartArray))
+    {
+        return false;
+    }
+
+    while (reader.Type() == JsonReader::Token::StartArray)
+    {
+        reader.Next();
+
+        std::pmr::vector<EnumDefinition::Entry> entries;
+        while (reader.Type() == JsonReader::Token::Number)
+        {
+            unsigned int index = reader.Current().GetInt();
+
+            if (!reader.Next() || reader.Type() != JsonReader::Token::String)
+            {
+                reader.Fail();
+                Clear();
+                return false;
+            }
+
+            entries.emplace_back(index, TypedHandle<std::string>::Deserialize(reader.Current()));
+            reader.Next();
+        }
+
+        if (!reader.Consume(JsonReader::Token::EndArray))
+        {
+            Clear();
+            return false;
+        }
+
+        Insert(std::make_shared<const EnumDefinition>(std::move(entries)));
+    }
+
+    if (!reader.Consume(JsonReader::Token::EndArray))
+    {
+        Clear();
+        return false;
+    }
 
-    return std::make_any<float>(value);
+    return true;
 }
 
 
-std::string TSys::FloatHandler::ApiName() const
+TSys::EnumSchemaTable* TSys::EnumSchemaTable::Current()
 {
-    return "Float";
+    return currentSchemaTable;
 }
 
 
-std::any TSys::FloatHandler::FromPython(const boost::python::object& obj) const
+TSys::EnumSchemaScope::EnumSchemaScope(EnumSchemaTable& table)
 {
-    return ExtractPythonToAny<float>(obj);
+    previous = currentSchemaTable;
+    currentSchemaTable = &table;
 }
 
 
-boost::python::object TSys::FloatHandler::ToPython(const std::any& value) const
+TSys::EnumSchemaScope::~EnumSchemaScope()
 {
-    return boost::python::object(std::any_cast<float>(value));
+    currentSchemaTable = previous;
 }
 
 
-void TSys::FloatHandler::SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
-                                        rapidjson::Document& doc) const
+// Invalid Any Cast.
+size_t TSys::InvalidAnyCast::Hash()
 {
-    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
-
-    jsonValue.PushBack(rapidjson::Value().SetString(
-                               vname.c_str(), (rapidjson::SizeType)vname.size(), doc.GetAllocator()),
-                       doc.GetAllocator());
+    return typeid(InvalidAnyCast).hash_code();
+}
 
-    rapidjson::Value floatValue;
-    float saveValue = std::any_cast<float>(v);
-    floatValue.SetFloat(saveValue);
 
-    jsonValue.PushBack<float>(saveValue, doc.GetAllocator());
+bool TSys::InvalidAnyCast::IsInvalid(const std::any& other)
+{
+    return (other.type().hash_code() == Hash());
 }
 
 
-std::any TSys::FloatHandler::DeserializeValue(const std::any&, rapidjson::Value& value) const
+bool TSys::InvalidAnyCast::IsValid(const std::any& other)
 {
-    float result = value.GetArray()[1].GetFloat();
-    return std::make_any<float>(result);
+    return (!IsInvalid(other));
 }
 
 
-void TSys::FloatHandler::SerializeConstruction(const std::any& v, rapidjson::Value& value,
-                                               rapidjson::Document& doc) const
+// Any value
+TSys::AnyValue::AnyValue(std::any v)
 {
-    IntHandler().SerializeConstruction(v, value, doc);
+    value = std::move(v);
+    id = TypeRegistry::GetRegistry()->ReserveTypeId(value.type());
 }
 
 
-std::any TSys::FloatHandler::DeserializeConstruction(rapidjson::Value& value) const
+void TSys::AnyValue::SetInput(const std::any& val)
 {
-    return InitValue();
+    value = val;
+    id = TypeRegistry::GetRegistry()->ReserveTypeId(value.type());
+    ClearConversionCache();
+}
+
+
+size_t TSys::AnyValue::Hash() const
+{
+    return value.type().hash_code();
+}
+
+
+TSys::TypeId TSys::AnyValue::Id() const
+{
+    return id;
+}
+
+
+std::string TSys::AnyValue::Name() const
+{
+    return value.type().name();
+}
+
+
+std::any TSys::AnyValue::InputValue() const
+{
+    return value;
+}
+
+
+const std::any& TSys::AnyValue::Input() const
+{
+    return value;
+}
+
+
+boost::python::object TSys::AnyValue::Python_Get()
+{
+    auto handler = TypeRegistry::GetRegistry()->GetTypeHandle(id);
+    if (!handler)
+    {
+        return {};
+    }
+
+    return handler->ToPython(value);
+}
+
+bool TSys::AnyValue::Python_Set(boost::python::object val)
+{
+    auto handler = TypeRegistry::GetRegistry()->GetTypeHandle(val);
+    if (!handler)
+    {
+        return false;
+    }
+
+    value = handler->FromPython(val);
+    id = TypeRegistry::GetRegistry()->ReserveTypeId(value.type());
+    ClearConversionCache();
+    return true;
+}
+
+void TSys::AnyValue::EnableConversionCache(bool enable)
+{
+    cacheConversions = enable;
+    if (!enable)
+    {
+        ClearConversionCache();
+    }
+}
+
+
+bool TSys::AnyValue::ConversionCacheEnabled() const
+{
+    return cacheConversions;
+}
+
+
+void TSys::AnyValue::ClearConversionCache()
+{
+    conversions.clear();
+    lastConversion.reset();
+}
+
+
+const std::any& TSys::AnyValue::CacheConversion(const TypeHandler& handler, std::any converted)
+{
+    conversions.push_back({handler.Id(), handler.Hash(), std::move(converted)});
+    return conversions.back().value;
+}
+
+
+std::any TSys::AnyValue::ConvertTo(size_t hash)
+{
+    if (hash == Hash())
+    {
+        return value;
+    }
+
+    // Skips the registry lookup.
+    for (const auto& conversion : conversions)
+    {
+        if (conversion.hash == hash)
+        {
+            return conversion.value;
+        }
+    }
+
+    return ConvertTo(TypeRegistry::GetRegistry()->GetTypeIdByHash(hash));
+}
+
+
+const std::any* TSys::AnyValue::CachedConversion(TypeId targetId) const
+{
+    if (targetId == id)
+    {
+        return &value;
+    }
+
+    for (const auto& conversion : conversions)
+    {
+        if (conversion.id == targetId)
+        {
+            return &conversion.value;
+        }
+    }
+
+    return nullptr;
+}
+
+
+std::any TSys::AnyValue::ConvertTo(TypeId targetId)
+{
+    if (const std::any* cached = CachedConversion(targetId))
+    {
+        return *cached;
+    }
+
+    TypeRegistry::ReadGuard guard;
+
+    const TypeHandler* handler = TypeRegistry::GetRegistry()->FindTypeHandle(targetId);
+    if (!handler)
+    {
+        return std::make_any<InvalidAnyCast>(InvalidAnyCast());
+    }
+
+    std::any converted = handler->ConvertFrom(value, value);
+    if (!cacheConversions || !converted.has_value())
+    {
+        return converted;
+    }
+
+    return CacheConversion(*handler, std::move(converted));
+}
+
+
+const std::any& TSys::AnyValue::ConvertToRef(TypeId targetId)
+{
+    if (const std::any* cached = CachedConversion(targetId))
+    {
+        return *cached;
+    }
+
+    TypeRegistry::ReadGuard guard;
+
+    const TypeHandler* handler = TypeRegistry::GetRegistry()->FindTypeHandle(targetId);
+    if (!handler)
+    {
+        lastConversion = std::make_any<InvalidAnyCast>(InvalidAnyCast());
+        return lastConversion;
+    }
+
+    std::any converted = handler->ConvertFrom(value, value);
+    if (cacheConversions && converted.has_value())
+    {
+        return CacheConversion(*handler, std::move(converted));
+    }
+
+    lastConversion = std::move(converted);
+    return lastConversion;
+}
+
+bool TSys::AnyValue::operator == (const AnyValue& other) const
+{
+    if (id != other.Id())
+    {
+        return false;
+    }
+
+    TypeRegistry::ReadGuard guard;
+
+    const TypeHandler* handler = TypeRegistry::GetRegistry()->FindTypeHandle(id);
+    if (!handler)
+    {
+        return false;
+    }
+
+    return handler->CompareValue(value, other.Input());
+}
+
+bool TSys::AnyValue::operator == (const std::any& other) const
+{
+    if (Hash() != other.type().hash_code())
+    {
+        return false;
+    }
+
+    TypeRegistry::ReadGuard guard;
+
+    const TypeHandler* handler = TypeRegistry::GetRegistry()->FindTypeHandle(id);
+    if (!handler)
+    {
+        return false;
+    }
+
+    return handler->CompareValue(value, other);
+}
+
+
+// String
+template<typename N>
+struct NumberToStr
+{
+    typedef std::string BatchTarget;
+
+    // Shortest text reading back to the same value, locale independent.
+    static size_t Format(N val, char* buffer, size_t size)
+    {
+        return (size_t)(std::to_chars(buffer, buffer + size, val).ptr - buffer);
+    }
+
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        char buffer[64];
+        size_t size = Format(std::any_cast<N>(from), buffer, sizeof(buffer));
+
+        return std::make_any<std::string>(buffer, size);
+    }
+
+    // Written through a stack buffer so that result strings
+    // reuse their own storage.
+    static void Batch(const N* sources, std::string* results, size_t count)
+    {
+        char buffer[64];
+        for (size_t i = 0; i < count; i++)
+        {
+            results[i].assign(buffer, Format(sources[i], buffer, sizeof(buffer)));
+        }
+    }
+};
+
+
+// Parses the number at the start of a string as the std::sto* functions
+// do, leading spaces and sign included, without locale or exceptions.
+// String converters return an empty std::any when parsing fails.
+template<typename N>
+static bool ParseNumber(const std::string& str, N& value)
+{
+    const char* first = str.data();
+    const char* last = first + str.size();
+
+    while (first != last && std::isspace((unsigned char)*first))
+    {
+        first++;
+    }
+
+    if (first != last && *first == '+' && (last - first) > 1 && first[1] != '-')
+    {
+        first++;
+    }
+
+    return std::from_chars(first, last, value).ec == std::errc();
+}
+
+
+template<typename C>
+struct CharTypeToStr
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        return std::make_any<std::string>(
+                std::string(
+                        std::any_cast<C>(
+                                from
+                        )
+                )
+        );
+    }
+};
+
+
+struct EnumToStr
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        auto enum_ = std::any_cast<TSys::Enum>(from);
+        return std::make_any<std::string>(enum_.CurrentValue());
+    }
+};
+
+
+// Set values names, separated by '|'.
+struct FlagsToStr
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        std::string result;
+        for (const auto& value : std::any_cast<const TSys::EnumFlags&>(from).Values())
+        {
+            if (!result.empty())
+            {
+                result.push_back('|');
+            }
+
+            result.append(value);
+        }
+
+        return std::make_any<std::string>(std::move(result));
+    }
+};
+
+
+
+TSys::StringHandler::StringHandler()
+{
+    RegisterConverter<int, NumberToStr<int>>();
+    RegisterConverter<float, NumberToStr<float>>();
+    RegisterConverter<double, NumberToStr<double>>();
+    RegisterConverter<Enum, EnumToStr>();
+    RegisterConverter<EnumFlags, FlagsToStr>();
+    RegisterConverter<AnyValue, AnyConverter>();
+    RegisterConverter<const char*, CharTypeToStr<const char*>>();
+    RegisterConverter<char*, CharTypeToStr<char*>>();
+}
+
+
+std::any TSys::StringHandler::InitValue() const
+{
+    return std::make_any<std::string>(std::string(""));
+}
+
+
+std::string TSys::StringHandler::ApiName() const
+{
+    return "String";
+}
+
+
+std::any TSys::StringHandler::FromPython(const boost::python::object& obj) const
+{
+    if (!PyUnicode_Check(obj.ptr()))
+    {
+        return std::make_any<std::string>("");
+    }
+
+    std::string val = PyUnicode_AsUTF8(obj.ptr());
+    return std::make_any<std::string>(val);
+}
+
+
+boost::python::object TSys::StringHandler::ToPython(const std::any& value) const
+{
+    return boost::python::object(std::any_cast<std::string>(value));
+}
+
+
+void TSys::StringHandler::SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
+                                         rapidjson::Document& doc) const
+{
+    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
+
+    jsonValue.PushBack(rapidjson::Value().SetString(
+                               vname.c_str(), (rapidjson::SizeType)vname.size(), doc.GetAllocator()),
+                       doc.GetAllocator());
+
+    rapidjson::Value saveValue;
+    TypedHandle<std::string>::Serialize(std::any_cast<const std::string&>(v), saveValue, doc);
+
+    jsonValue.PushBack(saveValue, doc.GetAllocator());
+}
+
+
+std::any TSys::StringHandler::DeserializeValue(const std::any&, rapidjson::Value& value) const
+{
+    return std::make_any<std::string>(TypedHandle<std::string>::Deserialize(value.GetArray()[1]));
+}
+
+
+void TSys::StringHandler::SerializeConstruction(const std::any& v, rapidjson::Value& value,
+                                                rapidjson::Document& doc) const
+{
+    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
+
+    // jsonValue.PushBack(rapidjson::StringRef(vname.c_str()), doc.GetAllocator());
+    value.PushBack(
+            rapidjson::Value().SetString(
+                    vname.c_str(), (rapidjson::SizeType)vname.size(),
+                    doc.GetAllocator()
+            ),
+            doc.GetAllocator()
+    );
+}
+
+
+std::any TSys::StringHandler::DeserializeConstruction(rapidjson::Value& value) const
+{
+    return InitValue();
+}
+
+
+void TSys::StringHandler::WriteValue(const std::any& v, JsonWriter& writer) const
+{
+    writer.TypeName(ApiName());
+    TypedHandle<std::string>::Serialize(std::any_cast<const std::string&>(v), writer);
+}
+
+
+void TSys::StringHandler::WriteConstruction(const std::any& v, JsonWriter& writer) const
+{
+    writer.TypeName(ApiName());
+}
+
+
+std::any TSys::StringHandler::ReadValue(const std::any& v, JsonReader& reader) const
+{
+    if (!reader.Consume(JsonReader::Token::String) ||
+        reader.Type() != JsonReader::Token::String)
+    {
+        reader.Fail();
+        return v;
+    }
+
+    std::any result = std::make_any<std::string>(TypedHandle<std::string>::Deserialize(reader.Current()));
+    reader.Next();
+
+    return result;
+}
+
+
+std::any TSys::StringHandler::ReadConstruction(JsonReader& reader) const
+{
+    reader.Consume(JsonReader::Token::String);
+
+    return InitValue();
+}
+
+
+// Python arrays, through the buffer protocol.
+// Exposes values as a read-only typed memoryview sharing their memory.
+template<class T>
+static boost::python::object ValuesToPythonArray(const T* values, size_t count, const char* format)
+{
+    PyObject* bytes = PyMemoryView_FromMemory(
+            const_cast<char*>(reinterpret_cast<const char*>(values)),
+            (Py_ssize_t)(count * sizeof(T)), PyBUF_READ);
+    if (!bytes)
+    {
+        PyErr_Clear();
+        return {};
+    }
+
+    boost::python::object view{boost::python::handle<>(bytes)};
+
+    PyObject* typed = PyObject_CallMethod(view.ptr(), "cast", "s", format);
+    if (!typed)
+    {
+        PyErr_Clear();
+        return {};
+    }
+
+    return boost::python::object(boost::python::handle<>(typed));
+}
+
+
+// Converts items of type Item to T, in C order.
+template<class T, class Item>
+static void ReadBufferItems(const Py_buffer& view, std::vector<T>& values)
+{
+    size_t count = view.itemsize ? (size_t)(view.len / view.itemsize) : 0;
+    values.resize(count);
+
+    if (PyBuffer_IsContiguous(&view, 'C'))
+    {
+        const Item* items = static_cast<const Item*>(view.buf);
+        if constexpr (std::is_same_v<T, Item>)
+        {
+            std::memcpy(values.data(), items, count * sizeof(T));
+        }
+        else
+        {
+            TSys::BatchKernel<Item, T>::Run(items, values.data(), count);
+        }
+
+        return;
+    }
+
+    std::vector<Py_ssize_t> index(view.ndim, 0);
+    for (size_t i = 0; i < count; i++)
+    {
+        const char* item = static_cast<const char*>(view.buf);
+        for (int d = 0; d < view.ndim; d++)
+        {
+            item += index[d] * view.strides[d];
+        }
+
+        Item value;
+        std::memcpy(&value, item, sizeof(Item));
+        values[i] = static_cast<T>(value);
+
+        for (int d = view.ndim - 1; d >= 0; d--)
+        {
+            if (++index[d] < view.shape[d])
+            {
+                break;
+            }
+
+            index[d] = 0;
+        }
+    }
+}
+
+
+// Dispatches on buffer struct format kind and item size, only single
+// numeric items in native byte order are read.
+template<class T>
+static bool ReadBuffer(const Py_buffer& view, std::vector<T>& values)
+{
+    const char* format = view.format ? view.format : "B";
+
+    const uint16_t order = 1;
+    bool little = *reinterpret_cast<const uint8_t*>(&order) == 1;
+
+    if (*format == '@' || *format == '=')
+    {
+        format++;
+    }
+    else if (*format == '<' || *format == '>' || *format == '!')
+    {
+        if ((*format == '<') != little)
+        {
+            return false;
+        }
+
+        format++;
+    }
+
+    if (!format[0] || format[1])
+    {
+        return false;
+    }
+
+    switch (format[0])
+    {
+        case '?':
+            if (view.itemsize != 1)
+                return false;
+
+            ReadBufferItems<T, bool>(view, values);
+            return true;
+
+        case 'b': case 'h': case 'i': case 'l': case 'q': case 'n':
+            switch (view.itemsize)
+            {
+                case 1: ReadBufferItems<T, int8_t>(view, values); return true;
+                case 2: ReadBufferItems<T, int16_t>(view, values); return true;
+                case 4: ReadBufferItems<T, int32_t>(view, values); return true;
+                case 8: ReadBufferItems<T, int64_t>(view, values); return true;
+                default: return false;
+            }
+
+        case 'B': case 'H': case 'I': case 'L': case 'Q': case 'N':
+            switch (view.itemsize)
+            {
+                case 1: ReadBufferItems<T, uint8_t>(view, values); return true;
+                case 2: ReadBufferItems<T, uint16_t>(view, values); return true;
+                case 4: ReadBufferItems<T, uint32_t>(view, values); return true;
+                case 8: ReadBufferItems<T, uint64_t>(view, values); return true;
+                default: return false;
+            }
+
+        case 'f': case 'd':
+            switch (view.itemsize)
+            {
+                case 4: ReadBufferItems<T, float>(view, values); return true;
+                case 8: ReadBufferItems<T, double>(view, values); return true;
+                default: return false;
+            }
+
+        default:
+            return false;
+    }
+}
+
+
+template<class T>
+static bool PythonArrayToValues(const boost::python::object& obj, std::vector<T>& values)
+{
+    Py_buffer view;
+    if (PyObject_GetBuffer(obj.ptr(), &view, PyBUF_FORMAT | PyBUF_STRIDES) != 0)
+    {
+        PyErr_Clear();
+        return false;
+    }
+
+    bool success = ReadBuffer(view, values);
+    PyBuffer_Release(&view);
+
+    return success;
+}
+
+
+// Bool
+struct StrToBool
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        const auto& str = std::any_cast<const std::string&>(from);
+
+        if (str == "true")
+        {
+            return std::make_any<bool>(true);
+        }
+
+        if (str == "false")
+        {
+            return std::make_any<bool>(false);
+        }
+
+        double number;
+        if (ParseNumber(str, number))
+        {
+            return std::make_any<bool>(number != 0.0);
+        }
+
+        return {};
+    }
+};
+
+
+struct EnumToBool
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        return std::make_any<bool>(std::any_cast<TSys::Enum>(from).CurrentIndex());
+    }
+};
+
+
+TSys::BoolHandler::BoolHandler(): TSys::GenericTypeHandler<bool>()
+{
+    RegisterConstructibleConverter<int>();
+    RegisterConstructibleConverter<float>();
+    RegisterConstructibleConverter<double>();
+    RegisterConverter<std::string, StrToBool>();
+    RegisterConverter<Enum, EnumToBool>();
+    RegisterConverter<AnyValue, AnyConverter>();
+}
+
+
+std::string TSys::BoolHandler::ApiName() const
+{
+    return "Bool";
+}
+
+
+std::any TSys::BoolHandler::InitValue() const
+{
+    return std::make_any<bool>(true);
+}
+
+
+std::any TSys::BoolHandler::FromPython(const boost::python::object& obj) const
+{
+    return ExtractPythonToAny<bool>(obj);
+}
+
+
+boost::python::object TSys::BoolHandler::ToPython(const std::any& value) const
+{
+    return boost::python::object(std::any_cast<bool>(value));
+}
+
+
+void TSys::BoolHandler::SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
+                                       rapidjson::Document& doc) const
+{
+    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
+
+    jsonValue.PushBack(rapidjson::Value().SetString(
+                               vname.c_str(), (rapidjson::SizeType)vname.size(), doc.GetAllocator()),
+                       doc.GetAllocator());
+
+    rapidjson::Value saveValue;
+    TypedHandle<bool>::Serialize(std::any_cast<const bool&>(v), saveValue, doc);
+
+    jsonValue.PushBack(saveValue, doc.GetAllocator());
+}
+
+
+std::any TSys::BoolHandler::DeserializeValue(const std::any&, rapidjson::Value& value) const
+{
+    return std::make_any<bool>(TypedHandle<bool>::Deserialize(value.GetArray()[1]));
+}
+
+
+void TSys::BoolHandler::SerializeConstruction(const std::any& v, rapidjson::Value& value,
+                                              rapidjson::Document& doc) const
+{
+    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
+
+    // jsonValue.PushBack(rapidjson::StringRef(vname.c_str()), doc.GetAllocator());
+    value.PushBack(
+            rapidjson::Value().SetString(
+                    vname.c_str(), (rapidjson::SizeType)vname.size(),
+                    doc.GetAllocator()
+            ),
+            doc.GetAllocator()
+    );
+}
+
+
+std::any TSys::BoolHandler::DeserializeConstruction(rapidjson::Value& value) const
+{
+    return InitValue();
+}
+
+
+void TSys::BoolHandler::WriteValue(const std::any& v, JsonWriter& writer) const
+{
+    writer.TypeName(ApiName());
+    TypedHandle<bool>::Serialize(std::any_cast<const bool&>(v), writer);
+}
+
+
+void TSys::BoolHandler::WriteConstruction(const std::any& v, JsonWriter& writer) const
+{
+    writer.TypeName(ApiName());
+}
+
+
+std::any TSys::BoolHandler::ReadValue(const std::any& v, JsonReader& reader) const
+{
+    if (!reader.Consume(JsonReader::Token::String) ||
+        reader.Type() != JsonReader::Token::Bool)
+    {
+        reader.Fail();
+        return v;
+    }
+
+    std::any result = std::make_any<bool>(TypedHandle<bool>::Deserialize(reader.Current()));
+    reader.Next();
+
+    return result;
+}
+
+
+std::any TSys::BoolHandler::ReadConstruction(JsonReader& reader) const
+{
+    reader.Consume(JsonReader::Token::String);
+
+    return InitValue();
+}
+
+
+// Int
+struct StrToInt
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        int value;
+        if (!ParseNumber(std::any_cast<const std::string&>(from), value))
+        {
+            return {};
+        }
+
+        return std::make_any<int>(value);
+    }
+};
+
+
+struct EnumToInt
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        auto en = std::any_cast<TSys::Enum>(from);
+        return std::make_any<int>(en.CurrentIndex());
+    }
+};
+
+
+// Packed bits of the first 32 values, flags set past them do not fit.
+struct FlagsToInt
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        const auto& flags = std::any_cast<const TSys::EnumFlags&>(from);
+
+        uint64_t bits = flags.Word(0);
+        if (bits >> 32)
+        {
+            return {};
+        }
+
+        for (size_t i = 1; i < flags.WordCount(); i++)
+        {
+            if (flags.Word(i))
+            {
+                return {};
+            }
+        }
+
+        return std::make_any<int>((int)(uint32_t)bits);
+    }
+};
+
+
+TSys::IntHandler::IntHandler(): TSys::GenericTypeHandler<int>()
+{
+    RegisterConstructibleConverter<bool>();
+    RegisterConstructibleConverter<float>();
+    RegisterConstructibleConverter<double>();
+    RegisterConverter<std::string, StrToInt>();
+    RegisterConverter<Enum, EnumToInt>();
+    RegisterConverter<EnumFlags, FlagsToInt>();
+    RegisterConverter<AnyValue, AnyConverter>();
+}
+
+
+std::string TSys::IntHandler::ApiName() const
+{
+    return "Int";
+}
+
+
+std::any TSys::IntHandler::InitValue() const
+{
+    return std::make_any<int>(0);
+}
+
+
+std::any TSys::IntHandler::FromPython(const boost::python::object& obj) const
+{
+    return ExtractPythonToAny<int>(obj);
+}
+
+
+boost::python::object TSys::IntHandler::ToPython(const std::any& value) const
+{
+    return boost::python::object(std::any_cast<int>(value));
+}
+
+
+boost::python::object TSys::IntHandler::ToPythonArray(const int* values, size_t count) const
+{
+    return ValuesToPythonArray(values, count, "i");
+}
+
+
+bool TSys::IntHandler::FromPythonArray(const boost::python::object& obj, std::vector<int>& values) const
+{
+    return PythonArrayToValues(obj, values);
+}
+
+
+void TSys::IntHandler::SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
+                                      rapidjson::Document& doc) const
+{
+    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
+
+    jsonValue.PushBack(rapidjson::Value().SetString(
+                               vname.c_str(), (rapidjson::SizeType)vname.size(), doc.GetAllocator()),
+                       doc.GetAllocator());
+
+    rapidjson::Value saveValue;
+    TypedHandle<int>::Serialize(std::any_cast<const int&>(v), saveValue, doc);
+
+    jsonValue.PushBack(saveValue, doc.GetAllocator());
+}
+
+
+std::any TSys::IntHandler::DeserializeValue(const std::any&, rapidjson::Value& value) const
+{
+    return std::make_any<int>(TypedHandle<int>::Deserialize(value.GetArray()[1]));
+}
+
+
+void TSys::IntHandler::SerializeConstruction(const std::any& v, rapidjson::Value& value,
+                                             rapidjson::Document& doc) const
+{
+    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
+
+    // jsonValue.PushBack(rapidjson::StringRef(vname.c_str()), doc.GetAllocator());
+    value.PushBack(
+            rapidjson::Value().SetString(
+                    vname.c_str(), (rapidjson::SizeType)vname.size(),
+                    doc.GetAllocator()
+            ),
+            doc.GetAllocator()
+    );
+}
+
+
+std::any TSys::IntHandler::DeserializeConstruction(rapidjson::Value& value) const
+{
+    return InitValue();
+}
+
+
+void TSys::IntHandler::WriteValue(const std::any& v, JsonWriter& writer) const
+{
+    writer.TypeName(ApiName());
+    TypedHandle<int>::Serialize(std::any_cast<const int&>(v), writer);
+}
+
+
+void TSys::IntHandler::WriteConstruction(const std::any& v, JsonWriter& writer) const
+{
+    writer.TypeName(ApiName());
+}
+
+
+std::any TSys::IntHandler::ReadValue(const std::any& v, JsonReader& reader) const
+{
+    if (!reader.Consume(JsonReader::Token::String) ||
+        reader.Type() != JsonReader::Token::Number)
+    {
+        reader.Fail();
+        return v;
+    }
+
+    std::any result = std::make_any<int>(TypedHandle<int>::Deserialize(reader.Current()));
+    reader.Next();
+
+    return result;
+}
+
+
+std::any TSys::IntHandler::ReadConstruction(JsonReader& reader) const
+{
+    reader.Consume(JsonReader::Token::String);
+
+    return InitValue();
+}
+
+
+// Float
+struct StrToFloat
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        float value;
+        if (!ParseNumber(std::any_cast<const std::string&>(from), value))
+        {
+            return {};
+        }
+
+        return std::make_any<float>(value);
+    }
+};
+
+
+struct EnumToFloat
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        auto en = std::any_cast<TSys::Enum>(from);
+        return std::make_any<float>((float)en.CurrentIndex());
+    }
+};
+
+
+TSys::FloatHandler::FloatHandler(): TSys::GenericTypeHandler<float>()
+{
+    RegisterConstructibleConverter<bool>();
+    RegisterConstructibleConverter<int>();
+    RegisterConstructibleConverter<double>();
+    RegisterConverter<std::string, StrToFloat>();
+    RegisterConverter<Enum, EnumToFloat>();
+    RegisterConverter<AnyValue, AnyConverter>();
+}
+
+
+std::any TSys::FloatHandler::InitValue() const
+{
+    return std::make_any<float>(0.0f);
+}
+
+
+std::string TSys::FloatHandler::ApiName() const
+{
+    return "Float";
+}
+
+
+std::any TSys::FloatHandler::FromPython(const boost::python::object& obj) const
+{
+    return ExtractPythonToAny<float>(obj);
+}
+
+
+boost::python::object TSys::FloatHandler::ToPython(const std::any& value) const
+{
+    return boost::python::object(std::any_cast<float>(value));
+}
+
+
+boost::python::object TSys::FloatHandler::ToPythonArray(const float* values, size_t count) const
+{
+    return ValuesToPythonArray(values, count, "f");
+}
+
+
+bool TSys::FloatHandler::FromPythonArray(const boost::python::object& obj, std::vector<float>& values) const
+{
+    return PythonArrayToValues(obj, values);
+}
+
+
+void TSys::FloatHandler::SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
+                                        rapidjson::Document& doc) const
+{
+    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
+
+    jsonValue.PushBack(rapidjson::Value().SetString(
+                               vname.c_str(), (rapidjson::SizeType)vname.size(), doc.GetAllocator()),
+                       doc.GetAllocator());
+
+    rapidjson::Value saveValue;
+    TypedHandle<float>::Serialize(std::any_cast<const float&>(v), saveValue, doc);
+
+    jsonValue.PushBack(saveValue, doc.GetAllocator());
+}
+
+
+std::any TSys::FloatHandler::DeserializeValue(const std::any&, rapidjson::Value& value) const
+{
+    return std::make_any<float>(TypedHandle<float>::Deserialize(value.GetArray()[1]));
+}
+
+
+void TSys::FloatHandler::SerializeConstruction(const std::any& v, rapidjson::Value& value,
+                                               rapidjson::Document& doc) const
+{
+    SerializeTypeName(ApiName(), value, doc);
+}
+
+
+std::any TSys::FloatHandler::DeserializeConstruction(rapidjson::Value& value) const
+{
+    return InitValue();
+}
+
+
+void TSys::FloatHandler::WriteValue(const std::any& v, JsonWriter& writer) const
+{
+    writer.TypeName(ApiName());
+    TypedHandle<float>::Serialize(std::any_cast<const float&>(v), writer);
+}
+
+
+void TSys::FloatHandler::WriteConstruction(const std::any& v, JsonWriter& writer) const
+{
+    writer.TypeName(ApiName());
+}
+
+
+std::any TSys::FloatHandler::ReadValue(const std::any& v, JsonReader& reader) const
+{
+    if (!reader.Consume(JsonReader::Token::String) ||
+        reader.Type() != JsonReader::Token::Number)
+    {
+        reader.Fail();
+        return v;
+    }
+
+    std::any result = std::make_any<float>(TypedHandle<float>::Deserialize(reader.Current()));
+    reader.Next();
+
+    return result;
+}
+
+
+std::any TSys::FloatHandler::ReadConstruction(JsonReader& reader) const
+{
+    reader.Consume(JsonReader::Token::String);
+
+    return InitValue();
 }
 
 
@@ -748,296 +2072,791 @@ struct StrToDouble
 {
     std::any operator()(const std::any& from, const std::any& to) const
     {
-        try
+        double value;
+        if (!ParseNumber(std::any_cast<const std::string&>(from), value))
+        {
+            return {};
+        }
+
+        return std::make_any<double>(value);
+    }
+};
+
+
+struct EnumToDouble
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        auto en = std::any_cast<TSys::Enum>(from);
+        return std::make_any<double>((double)en.CurrentIndex());
+    }
+};
+
+
+TSys::DoubleHandler::DoubleHandler(): TSys::GenericTypeHandler<double>()
+{
+    RegisterConstructibleConverter<bool>();
+    RegisterConstructibleConverter<int>();
+    RegisterConstructibleConverter<float>();
+    RegisterConverter<std::string, StrToDouble>();
+    RegisterConverter<Enum, EnumToDouble>();
+    RegisterConverter<AnyValue, AnyConverter>();
+}
+
+
+std::any TSys::DoubleHandler::InitValue() const
+{
+    return std::make_any<double>(0.0);
+}
+
+
+std::string TSys::DoubleHandler::ApiName() const
+{
+    return "Double";
+}
+
+
+std::any TSys::DoubleHandler::FromPython(const boost::python::object& obj) const
+{
+    return ExtractPythonToAny<double>(obj);
+}
+
+
+boost::python::object TSys::DoubleHandler::ToPython(const std::any& value) const
+{
+    return boost::python::object(std::any_cast<double>(value));
+}
+
+
+boost::python::object TSys::DoubleHandler::ToPythonArray(const double* values, size_t count) const
+{
+    return ValuesToPythonArray(values, count, "d");
+}
+
+
+bool TSys::DoubleHandler::FromPythonArray(const boost::python::object& obj, std::vector<double>& values) const
+{
+    return PythonArrayToValues(obj, values);
+}
+
+
+void TSys::DoubleHandler::SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
+                                         rapidjson::Document& doc) const
+{
+    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
+
+    jsonValue.PushBack(rapidjson::Value().SetString(
+                               vname.c_str(), (rapidjson::SizeType)vname.size(), doc.GetAllocator()),
+                       doc.GetAllocator());
+
+    rapidjson::Value saveValue;
+    TypedHandle<double>::Serialize(std::any_cast<const double&>(v), saveValue, doc);
+
+    jsonValue.PushBack(saveValue, doc.GetAllocator());
+}
+
+
+std::any TSys::DoubleHandler::DeserializeValue(const std::any&, rapidjson::Value& value) const
+{
+    return std::make_any<double>(TypedHandle<double>::Deserialize(value.GetArray()[1]));
+}
+
+
+void TSys::DoubleHandler::SerializeConstruction(const std::any& v, rapidjson::Value& value,
+                                                rapidjson::Document& doc) const
+{
+    SerializeTypeName(ApiName(), value, doc);
+}
+
+
+std::any TSys::DoubleHandler::DeserializeConstruction(rapidjson::Value& value) const
+{
+    return InitValue();
+}
+
+
+void TSys::DoubleHandler::WriteValue(const std::any& v, JsonWriter& writer) const
+{
+    writer.TypeName(ApiName());
+    TypedHandle<double>::Serialize(std::any_cast<const double&>(v), writer);
+}
+
+
+void TSys::DoubleHandler::WriteConstruction(const std::any& v, JsonWriter& writer) const
+{
+    writer.TypeName(ApiName());
+}
+
+
+std::any TSys::DoubleHandler::ReadValue(const std::any& v, JsonReader& reader) const
+{
+    if (!reader.Consume(JsonReader::Token::String) ||
+        reader.Type() != JsonReader::Token::Number)
+    {
+        reader.Fail();
+        return v;
+    }
+
+    std::any result = std::make_any<double>(TypedHandle<double>::Deserialize(reader.Current()));
+    reader.Next();
+
+    return result;
+}
+
+
+std::any TSys::DoubleHandler::ReadConstruction(JsonReader& reader) const
+{
+    reader.Consume(JsonReader::Token::String);
+
+    return InitValue();
+}
+
+
+// Enum
+struct BoolToEnum
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        auto en = std::any_cast<TSys::Enum>(to);
+        en.SetCurrentIndex((int)std::any_cast<bool>(from));
+        return std::make_any<TSys::Enum>(en);
+    }
+};
+
+struct IntToEnum
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        auto en = std::any_cast<TSys::Enum>(to);
+        en.SetCurrentIndex(std::any_cast<int>(from));
+        return std::make_any<TSys::Enum>(en);
+    }
+};
+
+struct FloatToEnum
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        auto en = std::any_cast<TSys::Enum>(to);
+        en.SetCurrentIndex((int)std::any_cast<float>(from));
+        return std::make_any<TSys::Enum>(en);
+    }
+};
+
+struct DoubleToEnum
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        auto en = std::any_cast<TSys::Enum>(to);
+        en.SetCurrentIndex((int)std::any_cast<double>(from));
+        return std::make_any<TSys::Enum>(en);
+    }
+};
+
+
+struct StrToEnum
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        auto en = std::any_cast<TSys::Enum>(to);
+        en.SetCurrentValue(std::any_cast<std::string>(from));
+        return std::make_any<TSys::Enum>(en);
+    }
+};
+
+
+struct FlagsToEnum
+{
+    std::any operator()(const std::any& from, const std::any& to) const
+    {
+        const auto& flags = std::any_cast<const TSys::EnumFlags&>(from);
+
+        auto en = std::any_cast<TSys::Enum>(to);
+        if (!en.Definition()->Size())
         {
-            return std::make_any<double>(std::stod(std::any_cast<std::string>(from)));
+            en = TSys::Enum(flags.Definition());
         }
-        catch (...)
+
+        // First set value, by name.
+        for (const auto& value : flags.Values())
         {
-            return 0.0;
+            if (en.SetCurrentValue(value))
+            {
+                break;
+            }
         }
+
+        return std::make_any<TSys::Enum>(en);
     }
 };
 
 
-struct EnumToDouble
+// Enum definitions, written after the construction type name as the
+// id of the definition in the current schema table, or as index, value
+// pairs.
+static void SerializeDefinition(const TSys::EnumDefinitionPtr& definition,
+                                rapidjson::Value& value, rapidjson::Document& doc)
 {
-    std::any operator()(const std::any& from, const std::any& to) const
+    // Definition is written once in the schema table.
+    if (auto table = TSys::EnumSchemaTable::Current())
     {
-        auto en = std::any_cast<TSys::Enum>(from);
-        return std::make_any<double>((double)en.CurrentIndex());
+        value.PushBack(rapidjson::Value().SetInt((int)table->Add(definition)), doc.GetAllocator());
+        return;
     }
-};
 
+    for (const auto& entry : definition->Values())
+    {
+        const std::pmr::string& st = entry.second;
 
-TSys::DoubleHandler::DoubleHandler(): TSys::GenericTypeHandler<double>()
+        rapidjson::Value& index = rapidjson::Value().SetInt((int)entry.first);
+        rapidjson::Value& enumValue = rapidjson::Value().SetString(
+                rapidjson::StringRef(st.c_str(), (rapidjson::SizeType)st.size()),
+                doc.GetAllocator());
+        value.PushBack(index, doc.GetAllocator());
+        value.PushBack(enumValue, doc.GetAllocator());
+    }
+}
+
+
+// Definition is allocated from resource when one is given.
+static TSys::EnumDefinitionPtr DeserializeDefinition(rapidjson::Value& value,
+                                                     std::pmr::memory_resource* resource=nullptr)
 {
-    RegisterConstructibleConverter<bool>();
-    RegisterConstructibleConverter<int>();
-    RegisterConstructibleConverter<float>();
-    RegisterConverter<std::string, StrToDouble>();
-    RegisterConverter<Enum, EnumToDouble>();
-    RegisterConverter<AnyValue, AnyConverter>();
+    rapidjson::Value& _array = value.GetArray();
+
+    // Single id, referencing a schema table definition.
+    if (_array.Size() == 2)
+    {
+        auto table = TSys::EnumSchemaTable::Current();
+        return table ? table->Definition(_array[1].GetInt()) : nullptr;
+    }
+
+    // Entries, names and index are all taken from resource.
+    std::pmr::vector<TSys::EnumDefinition::Entry> entries(
+            resource ? resource : std::pmr::get_default_resource());
+    entries.reserve(_array.Size() / 2);
+
+    for (unsigned int i = 1; i + 1 < _array.Size(); i += 2)
+    {
+        rapidjson::Value& key = _array[i];
+        rapidjson::Value& value_ = _array[i + 1];
+
+        entries.emplace_back(key.GetInt(), std::string_view(value_.GetString(), value_.GetStringLength()));
+    }
+
+    if (resource)
+    {
+        return std::allocate_shared<TSys::EnumDefinition>(
+                std::pmr::polymorphic_allocator<TSys::EnumDefinition>(resource),
+                std::move(entries)
+        );
+    }
+
+    return std::make_shared<const TSys::EnumDefinition>(std::move(entries));
 }
 
 
-std::any TSys::DoubleHandler::InitValue() const
+static void WriteDefinition(const TSys::EnumDefinitionPtr& definition, TSys::JsonWriter& writer)
 {
-    return std::make_any<double>(0.0);
+    if (auto table = TSys::EnumSchemaTable::Current())
+    {
+        writer.Int((int)table->Add(definition));
+        return;
+    }
+
+    for (const auto& entry : definition->Values())
+    {
+        writer.Int((int)entry.first);
+        writer.String(entry.second);
+    }
 }
 
 
-std::any TSys::DoubleHandler::CopyValue(const std::any& source) const
+// Reader is past the construction type name.
+static TSys::EnumDefinitionPtr ReadDefinition(TSys::JsonReader& reader)
 {
-    auto value = double(std::any_cast<double>(source));
+    std::pmr::vector<TSys::EnumDefinition::Entry> entries;
+    while (reader.Type() == TSys::JsonReader::Token::Number)
+    {
+        int index = reader.Current().GetInt();
+        reader.Next();
 
-    return std::make_any<double>(value);
+        // Single id, referencing a schema table definition.
+        if (entries.empty() && reader.Type() == TSys::JsonReader::Token::EndArray)
+        {
+            auto table = TSys::EnumSchemaTable::Current();
+            return table ? table->Definition(index) : nullptr;
+        }
+
+        if (reader.Type() != TSys::JsonReader::Token::String)
+        {
+            reader.Fail();
+            break;
+        }
+
+        entries.emplace_back(index, TSys::TypedHandle<std::string>::Deserialize(reader.Current()));
+        reader.Next();
+    }
+
+    return std::make_shared<const TSys::EnumDefinition>(std::move(entries));
 }
 
 
-std::string TSys::DoubleHandler::ApiName() const
+TSys::EnumHandler::EnumHandler(): TSys::TypeHandler()
 {
-    return "Double";
+    RegisterConverter<bool, BoolToEnum>();
+    RegisterConverter<int, IntToEnum>();
+    RegisterConverter<float, FloatToEnum>();
+    RegisterConverter<double, DoubleToEnum>();
+    RegisterConverter<std::string, StrToEnum>();
+    RegisterConverter<EnumFlags, FlagsToEnum>();
+    RegisterConverter<AnyValue, AnyConverter>();
 }
 
 
-std::any TSys::DoubleHandler::FromPython(const boost::python::object& obj) const
+std::any TSys::EnumHandler::InitValue() const
 {
-    return ExtractPythonToAny<double>(obj);
+    return std::make_any<Enum>(Enum());
 }
 
 
-boost::python::object TSys::DoubleHandler::ToPython(const std::any& value) const
+std::any TSys::EnumHandler::CopyValue(const std::any& source) const
 {
-    return boost::python::object(std::any_cast<double>(value));
+    // Definition is immutable and shared, copy is a reference count.
+    return std::make_any<Enum>(std::any_cast<const Enum&>(source));
 }
 
 
-void TSys::DoubleHandler::SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
-                                         rapidjson::Document& doc) const
+std::string TSys::EnumHandler::ApiName() const
+{
+    return "Enum";
+}
+
+
+std::any TSys::EnumHandler::FromPython(const boost::python::object& obj) const
+{
+    return ExtractPythonToAny<Enum>(obj);
+}
+
+
+boost::python::object TSys::EnumHandler::ToPython(const std::any& value) const
+{
+    return boost::python::object(std::any_cast<Enum>(value));
+}
+
+
+void TSys::EnumHandler::SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
+                                       rapidjson::Document& doc) const
 {
+    rapidjson::Value stringValue(rapidjson::kStringType);
+
     std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
 
     jsonValue.PushBack(rapidjson::Value().SetString(
                                vname.c_str(), (rapidjson::SizeType)vname.size(), doc.GetAllocator()),
                        doc.GetAllocator());
 
-    rapidjson::Value doubleValue;
-    double saveValue = std::any_cast<double>(v);
-    doubleValue.SetDouble(saveValue);
+    rapidjson::Value intValue;
+    Enum saveValue = std::any_cast<Enum>(v);
+    intValue.SetInt(saveValue.CurrentIndex());
+
+    jsonValue.PushBack(intValue, doc.GetAllocator());
+}
+
+
+std::any TSys::EnumHandler::DeserializeValue(const std::any& v, rapidjson::Value& value) const
+{
+    int result = value.GetArray()[1].GetInt();
+
+    Enum e = std::any_cast<Enum>(v);
+
+    e.SetCurrentIndex(result);
+    return std::make_any<Enum>(e);
+}
+
+
+void TSys::EnumHandler::SerializeConstruction(const std::any& v, rapidjson::Value& value,
+                                              rapidjson::Document& doc) const
+{
+    SerializeTypeName(ApiName(), value, doc);
+
+    SerializeDefinition(std::any_cast<const Enum&>(v).Definition(), value, doc);
+}
+
+
+std::any TSys::EnumHandler::DeserializeConstruction(rapidjson::Value& value) const
+{
+    return std::make_any<Enum>(Enum(DeserializeDefinition(value)));
+}
+
+
+std::any TSys::EnumHandler::DeserializeConstruction(rapidjson::Value& value,
+                                                    std::pmr::memory_resource* resource) const
+{
+    return std::make_any<Enum>(Enum(DeserializeDefinition(value, resource)));
+}
+
+
+void TSys::EnumHandler::WriteValue(const std::any& v, JsonWriter& writer) const
+{
+    writer.TypeName(ApiName());
+    writer.Int((int)std::any_cast<const Enum&>(v).CurrentIndex());
+}
+
+
+void TSys::EnumHandler::WriteConstruction(const std::any& v, JsonWriter& writer) const
+{
+    writer.TypeName(ApiName());
+
+    WriteDefinition(std::any_cast<const Enum&>(v).Definition(), writer);
+}
+
+
+std::any TSys::EnumHandler::ReadValue(const std::any& v, JsonReader& reader) const
+{
+    if (!reader.Consume(JsonReader::Token::String) ||
+        reader.Type() != JsonReader::Token::Number)
+    {
+        reader.Fail();
+        return v;
+    }
+
+    Enum e = std::any_cast<Enum>(v);
+    e.SetCurrentIndex(reader.Current().GetInt());
+    reader.Next();
+
+    return std::make_any<Enum>(e);
+}
+
+
+std::any TSys::EnumHandler::ReadConstruction(JsonReader& reader) const
+{
+    if (!reader.Consume(JsonReader::Token::String))
+    {
+        return std::make_any<Enum>(Enum());
+    }
+
+    return std::make_any<Enum>(Enum(ReadDefinition(reader)));
+}
+
+
+size_t TSys::EnumHandler::ValueHash(const std::any& value) const
+{
+    const auto& en = std::any_cast<const Enum&>(value);
+
+    size_t hash = en.Definition()->Hash();
+    CombineHash(hash, en.CurrentIndex());
 
-    jsonValue.PushBack<double>(saveValue, doc.GetAllocator());
+    return hash;
 }
 
 
-std::any TSys::DoubleHandler::DeserializeValue(const std::any&, rapidjson::Value& value) const
+bool TSys::EnumHandler::CompareValue(
+        const std::any& v1,
+        const std::any& v2)
+        const
 {
-    double result = value.GetArray()[1].GetDouble();
-    return std::make_any<double>(result);
+    size_t hash = Hash();
+    if (v1.type().hash_code() != hash ||
+        v2.type().hash_code() != hash)
+    {
+        return false;
+    }
+
+    return (std::any_cast<const Enum&>(v1) ==
+            std::any_cast<const Enum&>(v2));
 }
 
 
-void TSys::DoubleHandler::SerializeConstruction(const std::any& v, rapidjson::Value& value,
-                                                rapidjson::Document& doc) const
+bool TSys::EnumHandler::CanConvertThrough() const
 {
-    IntHandler().SerializeConstruction(v, value, doc);
+    // Enum conversions need the target enum values.
+    return false;
 }
 
 
-std::any TSys::DoubleHandler::DeserializeConstruction(rapidjson::Value& value) const
+TSys::Value TSys::EnumHandler::ToValue(const std::any& v) const
 {
-    return IntHandler().InitValue();
+    return Value(std::any_cast<const Enum&>(v));
 }
 
 
-// Enum
-struct BoolToEnum
+// EnumFlags
+struct EnumToFlags
 {
     std::any operator()(const std::any& from, const std::any& to) const
     {
-        auto en = std::any_cast<TSys::Enum>(to);
-        en.SetCurrentIndex((int)std::any_cast<bool>(from));
-        return std::make_any<TSys::Enum>(en);
+        const auto& en = std::any_cast<const TSys::Enum&>(from);
+
+        auto flags = std::any_cast<TSys::EnumFlags>(to);
+        if (!flags.Size())
+        {
+            return std::make_any<TSys::EnumFlags>(TSys::EnumFlags(en));
+        }
+
+        flags.Clear();
+        flags.SetValue(en.CurrentValue());
+
+        return std::make_any<TSys::EnumFlags>(flags);
     }
 };
 
-struct IntToEnum
+
+struct IntToFlags
 {
     std::any operator()(const std::any& from, const std::any& to) const
     {
-        auto en = std::any_cast<TSys::Enum>(to);
-        en.SetCurrentIndex(std::any_cast<int>(from));
-        return std::make_any<TSys::Enum>(en);
+        auto flags = std::any_cast<TSys::EnumFlags>(to);
+
+        flags.Clear();
+        flags.SetWord(0, (uint32_t)std::any_cast<int>(from));
+
+        return std::make_any<TSys::EnumFlags>(flags);
     }
 };
 
-struct FloatToEnum
+
+struct StrToFlags
 {
     std::any operator()(const std::any& from, const std::any& to) const
     {
-        auto en = std::any_cast<TSys::Enum>(to);
-        en.SetCurrentIndex((int)std::any_cast<float>(from));
-        return std::make_any<TSys::Enum>(en);
+        auto flags = std::any_cast<TSys::EnumFlags>(to);
+        flags.Clear();
+
+        std::string_view str = std::any_cast<const std::string&>(from);
+        while (!str.empty())
+        {
+            size_t end = std::min(str.find('|'), str.size());
+            std::string_view name = str.substr(0, end);
+
+            while (!name.empty() && std::isspace((unsigned char)name.front()))
+            {
+                name.remove_prefix(1);
+            }
+
+            while (!name.empty() && std::isspace((unsigned char)name.back()))
+            {
+                name.remove_suffix(1);
+            }
+
+            flags.SetValue(name);
+            str.remove_prefix(std::min(end + 1, str.size()));
+        }
+
+        return std::make_any<TSys::EnumFlags>(flags);
     }
 };
 
-struct DoubleToEnum
+
+// Values of definitions with more than 64 entries, one '0' or '1'
+// character per entry.
+static std::string FlagsToBitString(const TSys::EnumFlags& flags)
 {
-    std::any operator()(const std::any& from, const std::any& to) const
+    std::string result(flags.Size(), '0');
+    for (size_t i = 0; i < result.size(); i++)
     {
-        auto en = std::any_cast<TSys::Enum>(to);
-        en.SetCurrentIndex((int)std::any_cast<double>(from));
-        return std::make_any<TSys::Enum>(en);
+        if (flags.TestPosition(i))
+        {
+            result[i] = '1';
+        }
     }
-};
 
+    return result;
+}
 
-struct StrToEnum
+
+static bool ReadPackedFlags(const rapidjson::Value& value, TSys::EnumFlags& flags)
 {
-    std::any operator()(const std::any& from, const std::any& to) const
+    flags.Clear();
+
+    if (value.IsUint64())
     {
-        auto en = std::any_cast<TSys::Enum>(to);
-        en.SetCurrentValue(std::any_cast<std::string>(from));
-        return std::make_any<TSys::Enum>(en);
+        flags.SetWord(0, value.GetUint64());
+        return true;
+    }
+
+    if (!value.IsString())
+    {
+        return false;
     }
-};
 
+    const char* str = value.GetString();
+    for (size_t i = 0; i < value.GetStringLength(); i++)
+    {
+        if (str[i] == '1')
+        {
+            flags.SetPosition(i);
+        }
+    }
 
-TSys::EnumHandler::EnumHandler(): TSys::TypeHandler()
+    return true;
+}
+
+
+TSys::EnumFlagsHandler::EnumFlagsHandler(): TSys::TypeHandler()
 {
-    RegisterConverter<bool, BoolToEnum>();
-    RegisterConverter<int, IntToEnum>();
-    RegisterConverter<float, FloatToEnum>();
-    RegisterConverter<double, DoubleToEnum>();
-    RegisterConverter<std::string, StrToEnum>();
+    RegisterConverter<Enum, EnumToFlags>();
+    RegisterConverter<int, IntToFlags>();
+    RegisterConverter<std::string, StrToFlags>();
     RegisterConverter<AnyValue, AnyConverter>();
 }
 
 
-std::any TSys::EnumHandler::InitValue() const
+std::any TSys::EnumFlagsHandler::InitValue() const
 {
-    return std::make_any<Enum>(Enum());
+    return std::make_any<EnumFlags>(EnumFlags());
 }
 
 
-std::any TSys::EnumHandler::CopyValue(const std::any& source) const
+std::any TSys::EnumFlagsHandler::CopyValue(const std::any& source) const
 {
-    Enum value = Enum(std::any_cast<Enum>(source));
-
-    return std::make_any<Enum>(value);
+    return std::make_any<EnumFlags>(std::any_cast<const EnumFlags&>(source));
 }
 
 
-std::string TSys::EnumHandler::ApiName() const
+std::string TSys::EnumFlagsHandler::ApiName() const
 {
-    return "Enum";
+    return "EnumFlags";
 }
 
 
-std::any TSys::EnumHandler::FromPython(const boost::python::object& obj) const
+std::any TSys::EnumFlagsHandler::FromPython(const boost::python::object& obj) const
 {
-    return ExtractPythonToAny<Enum>(obj);
+    return ExtractPythonToAny<EnumFlags>(obj);
 }
 
 
-boost::python::object TSys::EnumHandler::ToPython(const std::any& value) const
+boost::python::object TSys::EnumFlagsHandler::ToPython(const std::any& value) const
 {
-    return boost::python::object(std::any_cast<Enum>(value));
+    return boost::python::object(std::any_cast<EnumFlags>(value));
 }
 
 
-void TSys::EnumHandler::SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
-                                       rapidjson::Document& doc) const
+void TSys::EnumFlagsHandler::SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
+                                            rapidjson::Document& doc) const
 {
-    rapidjson::Value stringValue(rapidjson::kStringType);
-
-    std::string vname = TypeRegistry::GetRegistry()->GetTypeHandle(v)->ApiName();
+    std::string vname = ApiName();
 
     jsonValue.PushBack(rapidjson::Value().SetString(
                                vname.c_str(), (rapidjson::SizeType)vname.size(), doc.GetAllocator()),
                        doc.GetAllocator());
 
-    rapidjson::Value intValue;
-    Enum saveValue = std::any_cast<Enum>(v);
-    intValue.SetInt(saveValue.CurrentIndex());
+    const auto& flags = std::any_cast<const EnumFlags&>(v);
 
-    jsonValue.PushBack(intValue, doc.GetAllocator());
+    // Packed integer when values fit a word.
+    if (flags.Size() <= EnumFlags::WordBits)
+    {
+        jsonValue.PushBack(rapidjson::Value().SetUint64(flags.Word(0)), doc.GetAllocator());
+        return;
+    }
+
+    std::string st = FlagsToBitString(flags);
+    jsonValue.PushBack(rapidjson::Value().SetString(
+                               st.c_str(), (rapidjson::SizeType)st.size(), doc.GetAllocator()),
+                       doc.GetAllocator());
 }
 
 
-std::any TSys::EnumHandler::DeserializeValue(const std::any& v, rapidjson::Value& value) const
+std::any TSys::EnumFlagsHandler::DeserializeValue(const std::any& v, rapidjson::Value& value) const
 {
-    int result = value.GetArray()[1].GetInt();
+    EnumFlags flags = std::any_cast<EnumFlags>(v);
 
-    Enum e = std::any_cast<Enum>(v);
+    ReadPackedFlags(value.GetArray()[1], flags);
 
-    e.SetCurrentIndex(result);
-    return std::make_any<Enum>(e);
+    return std::make_any<EnumFlags>(flags);
 }
 
 
-void TSys::EnumHandler::SerializeConstruction(const std::any& v, rapidjson::Value& value,
-                                              rapidjson::Document& doc) const
+void TSys::EnumFlagsHandler::SerializeConstruction(const std::any& v, rapidjson::Value& value,
+                                                   rapidjson::Document& doc) const
 {
-    IntHandler().SerializeConstruction(v, value, doc);
+    std::string vname = ApiName();
 
-    Enum en = std::any_cast<Enum>(v);
-    for (int i : en.Indices())
-    {
-        std::string st = en.ValueAtIndex(i);
+    value.PushBack(rapidjson::Value().SetString(
+                           vname.c_str(), (rapidjson::SizeType)vname.size(), doc.GetAllocator()),
+                   doc.GetAllocator());
 
-        rapidjson::Value& index = rapidjson::Value().SetInt(i);
-        rapidjson::Value& enumValue = rapidjson::Value().SetString(
-                rapidjson::StringRef(st.c_str(), (rapidjson::SizeType)st.size()),
-                doc.GetAllocator());
-        value.PushBack(index, doc.GetAllocator());
-        value.PushBack(enumValue, doc.GetAllocator());
-    }
+    SerializeDefinition(std::any_cast<const EnumFlags&>(v).Definition(), value, doc);
 }
 
 
-std::any TSys::EnumHandler::DeserializeConstruction(rapidjson::Value& value) const
+std::any TSys::EnumFlagsHandler::DeserializeConstruction(rapidjson::Value& value) const
 {
-    Enum result;
+    return std::make_any<EnumFlags>(EnumFlags(DeserializeDefinition(value)));
+}
 
-    rapidjson::Value& _array = value.GetArray();
-    for (unsigned int i = 1; i < _array.Size(); i += 2)
-    {
-        rapidjson::Value& key = _array[i];
-        rapidjson::Value& value_ = _array[i + 1];
 
-        result.AddValue(key.GetInt(), value_.GetString());
+std::any TSys::EnumFlagsHandler::DeserializeConstruction(rapidjson::Value& value,
+                                                         std::pmr::memory_resource* resource) const
+{
+    return std::make_any<EnumFlags>(EnumFlags(DeserializeDefinition(value, resource)));
+}
+
+
+void TSys::EnumFlagsHandler::WriteValue(const std::any& v, JsonWriter& writer) const
+{
+    writer.TypeName(ApiName());
+
+    const auto& flags = std::any_cast<const EnumFlags&>(v);
+    if (flags.Size() <= EnumFlags::WordBits)
+    {
+        writer.Uint64(flags.Word(0));
+        return;
     }
 
-    return std::make_any<Enum>(result);
+    writer.String(FlagsToBitString(flags));
 }
 
 
-size_t TSys::EnumHandler::ValueHash(const std::any& value) const
+void TSys::EnumFlagsHandler::WriteConstruction(const std::any& v, JsonWriter& writer) const
+{
+    writer.TypeName(ApiName());
+
+    WriteDefinition(std::any_cast<const EnumFlags&>(v).Definition(), writer);
+}
+
+
+std::any TSys::EnumFlagsHandler::ReadValue(const std::any& v, JsonReader& reader) const
 {
-    std::string str;
-    Enum en = std::any_cast<Enum>(value);
+    EnumFlags flags = std::any_cast<EnumFlags>(v);
 
-    for (int i : en.Indices())
+    if (!reader.Consume(JsonReader::Token::String) ||
+        (reader.Type() != JsonReader::Token::Number &&
+         reader.Type() != JsonReader::Token::String) ||
+        !ReadPackedFlags(reader.Current(), flags))
     {
-        if (!str.empty())
-            str += ":";
+        reader.Fail();
+        return v;
+    }
+
+    reader.Next();
+
+    return std::make_any<EnumFlags>(flags);
+}
 
-        str += en.ValueAtIndex(i);
+
+std::any TSys::EnumFlagsHandler::ReadConstruction(JsonReader& reader) const
+{
+    if (!reader.Consume(JsonReader::Token::String))
+    {
+        return std::make_any<EnumFlags>(EnumFlags());
     }
 
-    str += ":" + std::to_string(en.CurrentIndex());
-    return std::hash<std::string>{}(str);
+    return std::make_any<EnumFlags>(EnumFlags(ReadDefinition(reader)));
 }
 
 
-bool TSys::EnumHandler::CompareValue(
+size_t TSys::EnumFlagsHandler::ValueHash(const std::any& value) const
+{
+    return std::any_cast<const EnumFlags&>(value).Hash();
+}
+
+
+bool TSys::EnumFlagsHandler::CompareValue(
         const std::any& v1,
         const std::any& v2)
         const
 {
-    Enum ev1;
-    Enum ev2;
     size_t hash = Hash();
     if (v1.type().hash_code() != hash ||
         v2.type().hash_code() != hash)
@@ -1045,8 +2864,21 @@ bool TSys::EnumHandler::CompareValue(
         return false;
     }
 
-    return (std::any_cast<Enum>(v1) ==
-            std::any_cast<Enum>(v2));
+    return (std::any_cast<const EnumFlags&>(v1) ==
+            std::any_cast<const EnumFlags&>(v2));
+}
+
+
+bool TSys::EnumFlagsHandler::CanConvertThrough() const
+{
+    // Flags conversions need the target flags definition.
+    return false;
+}
+
+
+TSys::Value TSys::EnumFlagsHandler::ToValue(const std::any& v) const
+{
+    return Value(std::any_cast<const EnumFlags&>(v));
 }
 
 
@@ -1055,10 +2887,7 @@ struct ToAny
 {
     std::any operator()(const std::any& from, const std::any& to) const
     {
-        auto val = std::any_cast<TSys::AnyValue>(to);
-        val.SetInput(from);
-
-        return std::make_any<TSys::AnyValue>(val);
+        return std::make_any<TSys::AnyValue>(TSys::AnyValue(from));
     }
 };
 
@@ -1071,6 +2900,7 @@ TSys::AnyHandler::AnyHandler(): TSys::TypeHandler()
     RegisterConverter<double, ToAny>();
     RegisterConverter<std::string, ToAny>();
     RegisterConverter<Enum, ToAny>();
+    RegisterConverter<EnumFlags, ToAny>();
 }
 
 
@@ -1082,9 +2912,7 @@ std::any TSys::AnyHandler::InitValue() const
 
 std::any TSys::AnyHandler::CopyValue(const std::any& source) const
 {
-    AnyValue value = std::any_cast<AnyValue>(source);
-
-    return std::make_any<AnyValue>(AnyValue(value));
+    return std::make_any<AnyValue>(std::any_cast<const AnyValue&>(source));
 }
 
 
@@ -1108,27 +2936,30 @@ std::any TSys::AnyHandler::FromPython(const boost::python::object& obj) const
 
 boost::python::object TSys::AnyHandler::ToPython(const std::any& value) const
 {
-    return boost::python::object(std::any_cast<AnyValue>(value));
+    return boost::python::object(std::any_cast<const AnyValue&>(value));
 }
 
 
 void TSys::AnyHandler::SerializeValue(const std::any& v, rapidjson::Value& jsonValue,
                                       rapidjson::Document& doc) const
 {
-    AnyValue value = std::any_cast<AnyValue>(v);
-    size_t hash = value.Hash();
+    const auto& value = std::any_cast<const AnyValue&>(v);
 
     rapidjson::Value& inValue = rapidjson::Value().SetArray();
 
-    auto handler = TypeRegistry::GetRegistry()->GetTypeHandle(hash);
+    auto handler = TypeRegistry::GetRegistry()->GetTypeHandle(value.Id());
     if(!handler)
     {
         return;
     }
 
-    handler->SerializeValue(value.InputValue(), inValue, doc);
+    handler->SerializeValue(value.Input(), inValue, doc);
 
-    jsonValue.PushBack(rapidjson::StringRef(value.Name().c_str()), doc.GetAllocator());
+    // Api name, resolved by name when read.
+    std::string name = handler->ApiName();
+    jsonValue.PushBack(rapidjson::Value().SetString(
+                               name.c_str(), (rapidjson::SizeType)name.size(), doc.GetAllocator()),
+                       doc.GetAllocator());
 
     jsonValue.PushBack(inValue, doc.GetAllocator());
 }
@@ -1136,26 +2967,47 @@ void TSys::AnyHandler::SerializeValue(const std::any& v, rapidjson::Value& jsonV
 
 std::any TSys::AnyHandler::DeserializeValue(const std::any& v, rapidjson::Value& value) const
 {
-    AnyValue val = std::any_cast<AnyValue>(v);
-
     // If no value was saved.
     if (!value.Size())
     {
-        return std::make_any<AnyValue>(val);
+        return v;
     }
 
     rapidjson::Value& name = value[0];
 
     rapidjson::Value& typeValue = value[1];
 
-    auto handle = TypeRegistry::GetRegistry()->GetTypeHandle(v);
+    auto handle = TypeRegistry::GetRegistry()->GetTypeHandle(
+            std::string_view(name.GetString(), name.GetStringLength()));
+    if (!handle)
+    {
+        return InitValue();
+    }
+
+    return std::make_any<AnyValue>(AnyValue(handle->DeserializeValue(handle->InitValue(), typeValue)));
+}
+
+
+std::any TSys::AnyHandler::DeserializeValue(const std::any& v, rapidjson::Value& value,
+                                            std::pmr::memory_resource* resource) const
+{
+    if (!value.Size())
+    {
+        return v;
+    }
+
+    rapidjson::Value& name = value[0];
+
+    auto handle = TypeRegistry::GetRegistry()->GetTypeHandle(
+            std::string_view(name.GetString(), name.GetStringLength()));
     if (!handle)
     {
         return InitValue();
     }
 
-    val.SetInput(handle->DeserializeValue(handle->InitValue(), typeValue));
-    return std::make_any<AnyValue>(val);
+    return std::make_any<AnyValue>(AnyValue(
+            handle->DeserializeValue(handle->InitValue(resource), value[1], resource)
+    ));
 }
 
 
@@ -1172,34 +3024,107 @@ std::any TSys::AnyHandler::DeserializeConstruction(rapidjson::Value& value) cons
 }
 
 
+void TSys::AnyHandler::WriteValue(const std::any& v, JsonWriter& writer) const
+{
+    const auto& value = std::any_cast<const AnyValue&>(v);
+
+    auto handler = TypeRegistry::GetRegistry()->GetTypeHandle(value.Id());
+    if(!handler)
+    {
+        return;
+    }
+
+    writer.TypeName(handler->ApiName());
+
+    writer.StartArray();
+    handler->WriteValue(value.Input(), writer);
+    writer.EndArray(0);
+}
+
+
+void TSys::AnyHandler::WriteConstruction(const std::any& v, JsonWriter& writer) const
+{
+
+}
+
+
+std::any TSys::AnyHandler::ReadValue(const std::any& v, JsonReader& reader) const
+{
+    // If no value was saved.
+    if (reader.Type() != JsonReader::Token::String)
+    {
+        return v;
+    }
+
+    auto handle = TypeRegistry::GetRegistry()->GetTypeHandle(
+            std::string_view(reader.Current().GetString(), reader.Current().GetStringLength()));
+    if (!handle)
+    {
+        reader.Fail();
+        return InitValue();
+    }
+
+    reader.Next();
+    if (!reader.Consume(JsonReader::Token::StartArray))
+    {
+        return InitValue();
+    }
+
+    std::any input = handle->ReadValue(handle->InitValue(), reader);
+    if (!reader.Consume(JsonReader::Token::EndArray))
+    {
+        return InitValue();
+    }
+
+    return std::make_any<AnyValue>(AnyValue(std::move(input)));
+}
+
+
+std::any TSys::AnyHandler::ReadConstruction(JsonReader& reader) const
+{
+    return std::make_any<AnyValue>(AnyValue());
+}
+
+
 size_t TSys::AnyHandler::ValueHash(const std::any& val) const
 {
-    auto anyval = std::any_cast<AnyValue>(val);
-    auto handler = TypeRegistry::GetRegistry()->GetTypeHandle(anyval.Hash());
+    const auto& anyval = std::any_cast<const AnyValue&>(val);
+
+    TypeRegistry::ReadGuard guard;
+
+    const TypeHandler* handler = TypeRegistry::GetRegistry()->FindTypeHandle(anyval.Id());
     if (!handler)
     {
         return 0;
     }
 
-    return handler->ValueHash(anyval.InputValue());
+    return handler->ValueHash(anyval.Input());
 }
 
 
 bool TSys::AnyHandler::CompareValue(const std::any& v1, const std::any& v2) const
 {
-    AnyValue av1;
-    AnyValue av2;
-    try
-    {
-        av1 = std::any_cast<AnyValue>(v1);
-        av2 = std::any_cast<AnyValue>(v2);
-    }
-    catch(std::bad_any_cast&)
+    auto av1 = std::any_cast<AnyValue>(&v1);
+    auto av2 = std::any_cast<AnyValue>(&v2);
+    if (!av1 || !av2)
     {
         return false;
     }
 
-    return (av1 == av2);
+    return (*av1 == *av2);
+}
+
+
+bool TSys::AnyHandler::CanConvertThrough() const
+{
+    // Any converters dispatch back to the registry.
+    return false;
+}
+
+
+TSys::Value TSys::AnyHandler::ToValue(const std::any& v) const
+{
+    return Value(std::any_cast<const AnyValue&>(v));
 }
 
 
@@ -1265,6 +3190,30 @@ std::any TSys::NoneHandler::DeserializeConstruction(rapidjson::Value& value) con
 }
 
 
+void TSys::NoneHandler::WriteValue(const std::any& v, JsonWriter& writer) const
+{
+
+}
+
+
+void TSys::NoneHandler::WriteConstruction(const std::any& v, JsonWriter& writer) const
+{
+
+}
+
+
+std::any TSys::NoneHandler::ReadValue(const std::any& v, JsonReader& reader) const
+{
+    return InitValue();
+}
+
+
+std::any TSys::NoneHandler::ReadConstruction(JsonReader& reader) const
+{
+    return InitValue();
+}
+
+
 size_t TSys::NoneHandler::ValueHash(const std::any& val) const
 {
     return 0;
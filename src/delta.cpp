@@ -0,0 +1,210 @@
+#include "include/delta.h"
+
+
+static void WriteEntry(const TSys::TypeHandlerPtr& handler, const std::any& value,
+                       rapidjson::Value& entry, rapidjson::Document& doc)
+{
+    std::string name = handler->ApiName();
+
+    rapidjson::Value construction(rapidjson::kArrayType);
+    handler->SerializeConstruction(value, construction, doc);
+
+    rapidjson::Value serialized(rapidjson::kArrayType);
+    handler->SerializeValue(value, serialized, doc);
+
+    entry.SetArray();
+    entry.PushBack(rapidjson::Value().SetString(
+                           name.c_str(), (rapidjson::SizeType)name.size(), doc.GetAllocator()),
+                   doc.GetAllocator());
+    entry.PushBack(construction, doc.GetAllocator());
+    entry.PushBack(serialized, doc.GetAllocator());
+}
+
+
+size_t TSys::DeltaSerializer::Serialize(const std::vector<NamedValue>& values,
+                                        rapidjson::Value& delta, rapidjson::Document& doc)
+{
+    generation++;
+
+    rapidjson::Value set(rapidjson::kObjectType);
+    rapidjson::Value removed(rapidjson::kArrayType);
+
+    size_t changes = 0;
+
+    for (const auto& [key, value] : values)
+    {
+        auto handler = TypeRegistry::GetRegistry()->GetTypeHandle(value);
+        if (!handler)
+        {
+            continue;
+        }
+
+        size_t hash = handler->ValueHash(value);
+
+        Slot& slot = slots[key];
+        bool changed = slot.type != handler->Id() || slot.hash != hash;
+
+        slot.type = handler->Id();
+        slot.hash = hash;
+        slot.generation = generation;
+
+        if (!changed)
+        {
+            continue;
+        }
+
+        rapidjson::Value entry;
+        WriteEntry(handler, value, entry, doc);
+
+        set.AddMember(rapidjson::Value().SetString(
+                              key.c_str(), (rapidjson::SizeType)key.size(), doc.GetAllocator()),
+                      entry, doc.GetAllocator());
+        changes++;
+    }
+
+    // Slots not seen in this save were removed.
+    for (auto iter = slots.begin(); iter != slots.end();)
+    {
+        if (iter->second.generation == generation)
+        {
+            ++iter;
+            continue;
+        }
+
+        removed.PushBack(rapidjson::Value().SetString(
+                                 iter->first.c_str(), (rapidjson::SizeType)iter->first.size(),
+                                 doc.GetAllocator()),
+                         doc.GetAllocator());
+        changes++;
+
+        iter = slots.erase(iter);
+    }
+
+    delta.SetObject();
+    delta.AddMember(rapidjson::StringRef("set"), set, doc.GetAllocator());
+    delta.AddMember(rapidjson::StringRef("removed"), removed, doc.GetAllocator());
+
+    return changes;
+}
+
+
+void TSys::DeltaSerializer::Reset()
+{
+    slots.clear();
+}
+
+
+bool TSys::DeltaSerializer::Apply(const rapidjson::Value& delta, rapidjson::Value& base,
+                                  rapidjson::Document& doc)
+{
+    if (!delta.IsObject() || !base.IsObject())
+    {
+        return false;
+    }
+
+    auto set = delta.FindMember("set");
+    if (set != delta.MemberEnd() && set->value.IsObject())
+    {
+        for (auto member = set->value.MemberBegin(); member != set->value.MemberEnd(); ++member)
+        {
+            rapidjson::Value entry;
+            entry.CopyFrom(member->value, doc.GetAllocator(), true);
+
+            auto iter = base.FindMember(member->name);
+            if (iter != base.MemberEnd())
+            {
+                iter->value = entry;
+                continue;
+            }
+
+            rapidjson::Value key;
+            key.CopyFrom(member->name, doc.GetAllocator(), true);
+            base.AddMember(key, entry, doc.GetAllocator());
+        }
+    }
+
+    bool success = true;
+
+    auto removed = delta.FindMember("removed");
+    if (removed != delta.MemberEnd() && removed->value.IsArray())
+    {
+        for (const auto& key : removed->value.GetArray())
+        {
+            if (!key.IsString())
+            {
+                success = false;
+                continue;
+            }
+
+            base.RemoveMember(key);
+        }
+    }
+
+    return success;
+}
+
+
+bool TSys::DeltaSerializer::Apply(rapidjson::Value& delta,
+                                  std::unordered_map<std::string, std::any>& values)
+{
+    if (!delta.IsObject())
+    {
+        return false;
+    }
+
+    bool success = true;
+
+    auto set = delta.FindMember("set");
+    if (set != delta.MemberEnd() && set->value.IsObject())
+    {
+        for (auto member = set->value.MemberBegin(); member != set->value.MemberEnd(); ++member)
+        {
+            std::any value = ReadEntry(member->value);
+            if (!value.has_value())
+            {
+                success = false;
+                continue;
+            }
+
+            values[std::string(member->name.GetString(), member->name.GetStringLength())] = value;
+        }
+    }
+
+    auto removed = delta.FindMember("removed");
+    if (removed != delta.MemberEnd() && removed->value.IsArray())
+    {
+        for (const auto& key : removed->value.GetArray())
+        {
+            if (!key.IsString())
+            {
+                success = false;
+                continue;
+            }
+
+            values.erase(std::string(key.GetString(), key.GetStringLength()));
+        }
+    }
+
+    return success;
+}
+
+
+std::any TSys::DeltaSerializer::ReadEntry(rapidjson::Value& entry)
+{
+    if (!entry.IsArray() || entry.Size() != 3 || !entry[0].IsString() ||
+        !entry[1].IsArray() || !entry[2].IsArray())
+    {
+        return {};
+    }
+
+    auto handler = TypeRegistry::GetRegistry()->GetTypeHandle(
+            std::string_view(entry[0].GetString(), entry[0].GetStringLength()));
+    if (!handler)
+    {
+        return {};
+    }
+
+    std::any construction = handler->DeserializeConstruction(entry[1]);
+
+    return handler->DeserializeValue(construction, entry[2]);
+}
@@ -0,0 +1,132 @@
+#include "include/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+
+// Below this many values threads cost more than they save.
+static constexpr size_t MinimumParallelCount = 1024;
+
+// Chunks per thread, so that threads finishing early take more work.
+static constexpr size_t ChunksPerThread = 4;
+
+
+// Writes values [begin, end) as the elements of an array, returns
+// them without the enclosing brackets.
+static std::string WriteChunk(const std::vector<TSys::HandlerValue>& values,
+                              size_t begin, size_t end)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    TSys::JsonWriterAdapter<rapidjson::Writer<rapidjson::StringBuffer>> adapter(writer);
+
+    writer.StartArray();
+    for (size_t i = begin; i < end; i++)
+    {
+        writer.StartArray();
+        if (values[i].first)
+        {
+            values[i].first->WriteValue(values[i].second, adapter);
+        }
+
+        writer.EndArray();
+    }
+
+    writer.EndArray();
+
+    return {buffer.GetString() + 1, buffer.GetSize() - 2};
+}
+
+
+std::string TSys::SerializeValues(const std::vector<HandlerValue>& values, unsigned int threads)
+{
+    if (!threads)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    if (threads == 1 || values.size() < MinimumParallelCount)
+    {
+        return "[" + WriteChunk(values, 0, values.size()) + "]";
+    }
+
+    size_t chunkCount = std::min(values.size(), (size_t)threads * ChunksPerThread);
+    size_t chunkSize = (values.size() + chunkCount - 1) / chunkCount;
+    chunkCount = (values.size() + chunkSize - 1) / chunkSize;
+
+    std::vector<std::string> chunks(chunkCount);
+    std::atomic<size_t> nextChunk{0};
+
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto work = [&]()
+    {
+        for (size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+        {
+            try
+            {
+                size_t begin = chunk * chunkSize;
+                chunks[chunk] = WriteChunk(values, begin, std::min(begin + chunkSize, values.size()));
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+
+    for (unsigned int i = 1; i < threads; i++)
+    {
+        workers.emplace_back(work);
+    }
+
+    work();
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+
+    size_t size = 2 + chunkCount;
+    for (const auto& chunk : chunks)
+    {
+        size += chunk.size();
+    }
+
+    std::string result;
+    result.reserve(size);
+
+    result.push_back('[');
+    for (size_t i = 0; i < chunkCount; i++)
+    {
+        if (i)
+        {
+            result.push_back(',');
+        }
+
+        result.append(chunks[i]);
+    }
+
+    result.push_back(']');
+
+    return result;
+}
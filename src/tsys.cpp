@@ -1,4 +1,7 @@
 #include <any>
+#include <deque>
+#include <algorithm>
+#include <charconv>
 #include "include/tsys.h"
 #include "rapidjson/document.h"
 #include <boost/python.hpp>
@@ -7,44 +10,787 @@
 
 TSys::Converter TSys::TypeHandler::GetConverter(const std::any& from) const
 {
-    auto idx = std::type_index(from.type());
-    if (converters.find(idx) != converters.end())
+    TypeId id = Id();
+    if (id != InvalidTypeId)
     {
-        return converters.at(idx);
+        auto registry = TypeRegistry::GetRegistry();
+        TypeRegistry::ReadGuard guard;
+
+        const auto& set = registry->Table().converterSets;
+        if (id < set.size() && set[id])
+        {
+            auto iter = set[id]->converters.find(std::type_index(from.type()));
+            if (iter != set[id]->converters.end())
+            {
+                return iter->second;
+            }
+        }
+
+        return {};
+    }
+
+    auto iter = converters.find(std::type_index(from.type()));
+    if (iter != converters.end())
+    {
+        return iter->second;
+    }
+
+    return {};
+}
+
+
+const std::unordered_map<std::type_index, TSys::Converter>& TSys::TypeHandler::Converters() const
+{
+    return converters;
+}
+
+
+TSys::TypeId TSys::TypeHandler::Id() const
+{
+    return registeredId.load(std::memory_order_acquire);
+}
+
+
+void TSys::TypeHandler::UpdateConverters(const std::function<void()>& update)
+{
+    // Handlers being built or used outside of the registry are not
+    // shared yet, they can be modified in place.
+    if (Id() == InvalidTypeId)
+    {
+        update();
+        return;
+    }
+
+    TypeRegistry::GetRegistry()->UpdateConverters(*this, update);
+}
+
+
+TSys::BatchConverter TSys::TypeHandler::GetBatchConverter(const std::type_index& from) const
+{
+    TypeId id = Id();
+    if (id != InvalidTypeId)
+    {
+        return TypeRegistry::GetRegistry()->GetBatchConverter(id, from);
+    }
+
+    auto iter = batchConverters.find(from);
+    if (iter == batchConverters.end())
+    {
+        return {};
+    }
+
+    return iter->second;
+}
+
+
+// Returns registry conversion from value type to handler type, must
+// be called with a TypeRegistry::ReadGuard held.
+static const TSys::ConversionSlot* FindConversion(TSys::TypeId id, const std::any& value)
+{
+    auto registry = TSys::TypeRegistry::GetRegistry();
+
+    return registry->GetConversion(
+            registry->GetTypeId(std::type_index(value.type())),
+            id
+    );
+}
+
+
+std::any TSys::TypeHandler::ConvertFrom(const std::any& sourceValue, std::any currentValue) const
+{
+    // Converters of registered handlers are only read from the
+    // registry snapshot, which includes direct ones.
+    TypeId id = Id();
+    if (id != InvalidTypeId)
+    {
+        TypeRegistry::ReadGuard guard;
+
+        const ConversionSlot* conversion = FindConversion(id, sourceValue);
+        if (!conversion)
+        {
+            return {};
+        }
+
+        return (*conversion)(sourceValue, currentValue);
+    }
+
+    // Handlers used outside of the registry only go through direct
+    // converters.
+    auto iter = converters.find(std::type_index(sourceValue.type()));
+    if (iter == converters.end())
+    {
+        return {};
     }
 
-    return {};
+    return iter->second(sourceValue, currentValue);
+}
+
+
+bool TSys::TypeHandler::CanConvertFrom(const std::any& value) const
+{
+    TypeId id = Id();
+    if (id != InvalidTypeId)
+    {
+        TypeRegistry::ReadGuard guard;
+        return FindConversion(id, value) != nullptr;
+    }
+
+    return converters.find(std::type_index(value.type())) != converters.end();
+}
+
+
+size_t TSys::TypeHandler::ConvertMany(const std::any* sources, std::any* results,
+                                      size_t count) const
+{
+    auto registry = TypeRegistry::GetRegistry();
+    TypeRegistry::ReadGuard guard;
+
+    TypeId id = Id();
+
+    const std::type_info* type = nullptr;
+    const ConversionSlot* conversion = nullptr;
+    const Converter* converter = nullptr;
+
+    size_t converted = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const std::any& source = sources[i];
+        if (!type || source.type() != *type)
+        {
+            type = &source.type();
+
+            conversion = nullptr;
+            converter = nullptr;
+            if (id != InvalidTypeId)
+            {
+                conversion = registry->GetConversion(
+                        registry->GetTypeId(std::type_index(*type)),
+                        id
+                );
+            }
+            else
+            {
+                auto iter = converters.find(std::type_index(*type));
+                if (iter != converters.end())
+                {
+                    converter = &iter->second;
+                }
+            }
+        }
+
+        if (conversion)
+        {
+            results[i] = (*conversion)(source, results[i]);
+        }
+        else if (converter)
+        {
+            results[i] = (*converter)(source, results[i]);
+        }
+        else
+        {
+            results[i].reset();
+        }
+
+        if (results[i].has_value())
+        {
+            converted++;
+        }
+    }
+
+    return converted;
+}
+
+
+bool TSys::TypeHandler::CanConvertThrough() const
+{
+    return true;
+}
+
+
+bool TSys::TypeHandler::operator==(TypeHandler* h) const
+{
+    return Hash() == h->Hash();
+}
+
+
+// Replays elements of a serialized array on writer.
+static void ReplayElements(rapidjson::Value& array, TSys::JsonWriter& writer)
+{
+    for (auto& element : array.GetArray())
+    {
+        element.Accept(writer);
+    }
+}
+
+
+void TSys::TypeHandler::WriteValue(const std::any& v, JsonWriter& writer) const
+{
+    rapidjson::Document document;
+    rapidjson::Value array(rapidjson::kArrayType);
+
+    SerializeValue(v, array, document);
+    ReplayElements(array, writer);
+}
+
+
+void TSys::TypeHandler::WriteConstruction(const std::any& v, JsonWriter& writer) const
+{
+    rapidjson::Document document;
+    rapidjson::Value array(rapidjson::kArrayType);
+
+    SerializeConstruction(v, array, document);
+    ReplayElements(array, writer);
+}
+
+
+template<typename N>
+static size_t FormatShortestNumber(N n, char* buffer)
+{
+    auto result = std::to_chars(buffer, buffer + TSys::JsonWriter::ShortestBufferSize - 2, n);
+    auto length = (size_t)(result.ptr - buffer);
+
+    // Keep a decimal point, so that it reads back as a floating point number.
+    if (std::find_if(buffer, result.ptr, [](char c) { return c == '.' || c == 'e'; }) == result.ptr)
+    {
+        buffer[length++] = '.';
+        buffer[length++] = '0';
+    }
+
+    return length;
+}
+
+
+size_t TSys::JsonWriter::FormatShortest(double d, char* buffer)
+{
+    return FormatShortestNumber(d, buffer);
+}
+
+
+size_t TSys::JsonWriter::FormatShortest(float f, char* buffer)
+{
+    return FormatShortestNumber(f, buffer);
+}
+
+
+std::any TSys::TypeHandler::ReadValue(const std::any& v, JsonReader& reader) const
+{
+    rapidjson::Document document;
+    rapidjson::Value array(rapidjson::kArrayType);
+
+    if (!reader.ReadElements(array, document.GetAllocator()))
+    {
+        return v;
+    }
+
+    return DeserializeValue(v, array);
+}
+
+
+std::any TSys::TypeHandler::ReadConstruction(JsonReader& reader) const
+{
+    rapidjson::Document document;
+    rapidjson::Value array(rapidjson::kArrayType);
+
+    if (!reader.ReadElements(array, document.GetAllocator()))
+    {
+        return InitValue();
+    }
+
+    return DeserializeConstruction(array);
+}
+
+
+bool TSys::JsonReader::Next()
+{
+    if (failed || token == Token::End)
+    {
+        return false;
+    }
+
+    token = Token::None;
+    if (!Read())
+    {
+        Fail();
+        return false;
+    }
+
+    // Read succeeds without a token once input is complete.
+    if (token == Token::None)
+    {
+        token = Token::End;
+        return false;
+    }
+
+    return true;
+}
+
+
+bool TSys::JsonReader::Consume(Token t)
+{
+    if (token != t)
+    {
+        Fail();
+        return false;
+    }
+
+    Next();
+    return !failed;
+}
+
+
+bool TSys::JsonReader::ReadJson(rapidjson::Value& value, rapidjson::Document::AllocatorType& allocator)
+{
+    switch (token)
+    {
+        case Token::String:
+            // Current string references reader storage, copy it.
+            value.SetString(current.GetString(), current.GetStringLength(), allocator);
+            Next();
+            return !failed;
+
+        case Token::Null:
+        case Token::Bool:
+        case Token::Number:
+            value.CopyFrom(current, allocator);
+            Next();
+            return !failed;
+
+        case Token::StartArray:
+            value.SetArray();
+            Next();
+
+            if (!ReadElements(value, allocator))
+            {
+                return false;
+            }
+
+            return Consume(Token::EndArray);
+
+        case Token::StartObject:
+            value.SetObject();
+            Next();
+
+            while (token == Token::Key)
+            {
+                rapidjson::Value name(current.GetString(), current.GetStringLength(), allocator);
+                rapidjson::Value member;
+
+                Next();
+                if (!ReadJson(member, allocator))
+                {
+                    return false;
+                }
+
+                value.AddMember(name, member, allocator);
+            }
+
+            return Consume(Token::EndObject);
+
+        default:
+            Fail();
+            return false;
+    }
+}
+
+
+bool TSys::JsonReader::ReadElements(rapidjson::Value& array, rapidjson::Document::AllocatorType& allocator)
+{
+    while (token != Token::EndArray)
+    {
+        rapidjson::Value element;
+        if (!ReadJson(element, allocator))
+        {
+            return false;
+        }
+
+        array.PushBack(element, allocator);
+    }
+
+    return true;
+}
+
+
+bool TSys::JsonReader::Null()
+{
+    token = Token::Null;
+    current.SetNull();
+    return true;
+}
+
+
+bool TSys::JsonReader::Bool(bool b)
+{
+    token = Token::Bool;
+    current.SetBool(b);
+    return true;
+}
+
+
+bool TSys::JsonReader::Int(int i)
+{
+    token = Token::Number;
+    current.SetInt(i);
+    return true;
+}
+
+
+bool TSys::JsonReader::Uint(unsigned u)
+{
+    token = Token::Number;
+    current.SetUint(u);
+    return true;
+}
+
+
+bool TSys::JsonReader::Int64(int64_t i)
+{
+    token = Token::Number;
+    current.SetInt64(i);
+    return true;
+}
+
+
+bool TSys::JsonReader::Uint64(uint64_t u)
+{
+    token = Token::Number;
+    current.SetUint64(u);
+    return true;
+}
+
+
+bool TSys::JsonReader::Double(double d)
+{
+    token = Token::Number;
+    current.SetDouble(d);
+    return true;
+}
+
+
+bool TSys::JsonReader::RawNumber(const Ch* str, rapidjson::SizeType length, bool copy)
+{
+    String(str, length, copy);
+    token = Token::Number;
+    return true;
+}
+
+
+bool TSys::JsonReader::String(const Ch* str, rapidjson::SizeType length, bool copy)
+{
+    // Insitu parsing hands strings that live in the parsed buffer.
+    if (!copy)
+    {
+        return Reference(Token::String, str, length);
+    }
+
+    buffer.assign(str, length);
+    current.SetString(rapidjson::StringRef(buffer.data(), (rapidjson::SizeType)buffer.size()));
+    token = Token::String;
+    return true;
+}
+
+
+bool TSys::JsonReader::Reference(Token t, const Ch* str, rapidjson::SizeType length)
+{
+    current.SetString(rapidjson::StringRef(str, length));
+    token = t;
+    return true;
+}
+
+
+bool TSys::JsonReader::StartObject()
+{
+    token = Token::StartObject;
+    return true;
+}
+
+
+bool TSys::JsonReader::Key(const Ch* str, rapidjson::SizeType length, bool copy)
+{
+    String(str, length, copy);
+    token = Token::Key;
+    return true;
+}
+
+
+bool TSys::JsonReader::EndObject(rapidjson::SizeType memberCount)
+{
+    token = Token::EndObject;
+    return true;
+}
+
+
+bool TSys::JsonReader::StartArray()
+{
+    token = Token::StartArray;
+    return true;
+}
+
+
+bool TSys::JsonReader::EndArray(rapidjson::SizeType elementCount)
+{
+    token = Token::EndArray;
+    return true;
+}
+
+
+TSys::Value TSys::TypeHandler::ToValue(const std::any& v) const
+{
+    return {};
+}
+
+
+bool TSys::TypeHandler::CompareValue(const Value& v1, const Value& v2) const
+{
+    return CompareValue(v1.ToAny(), v2.ToAny());
+}
+
+
+size_t TSys::TypeHandler::ValueHash(const Value& val) const
+{
+    return ValueHash(val.ToAny());
+}
+
+
+TSys::Value TSys::TypeHandler::CopyValue(const Value& source) const
+{
+    return source;
 }
 
 
-std::any TSys::TypeHandler::ConvertFrom(const std::any& sourceValue, std::any currentValue) const
+void TSys::TypeHandler::SerializeValue(const Value& v, rapidjson::Value& value,
+                                       rapidjson::Document& document) const
+{
+    SerializeValue(v.ToAny(), value, document);
+}
+
+
+TSys::Value TSys::TypeHandler::ConvertFrom(const Value& sourceValue,
+                                           const Value& currentValue) const
 {
-    if (!CanConvertFrom(sourceValue))
+    std::any result = ConvertFrom(sourceValue.ToAny(), currentValue.ToAny());
+    if (!result.has_value())
     {
         return {};
     }
 
-    Converter converter = GetConverter(sourceValue);
+    return ToValue(result);
+}
+
 
-    return converter(sourceValue, currentValue);
+std::any TSys::TypeHandler::InitValue(std::pmr::memory_resource* resource) const
+{
+    return InitValue();
 }
 
 
-bool TSys::TypeHandler::CanConvertFrom(const std::any& value) const
+std::any TSys::TypeHandler::DeserializeValue(const std::any& v, rapidjson::Value& value,
+                                             std::pmr::memory_resource* resource) const
 {
-    return bool(GetConverter(value));
+    return DeserializeValue(v, value);
 }
 
 
-bool TSys::TypeHandler::operator==(TypeHandler* h) const
+std::any TSys::TypeHandler::DeserializeConstruction(rapidjson::Value& value,
+                                                    std::pmr::memory_resource* resource) const
 {
-    return Hash() == h->Hash();
+    return DeserializeConstruction(value);
+}
+
+
+std::any TSys::ConversionPath::Convert(const std::any& sourceValue,
+                                       const std::any& currentValue) const
+{
+    std::any value = sourceValue;
+    for (size_t i = 0; i < steps.size(); i++)
+    {
+        const Step& step = steps[i];
+        if (i + 1 == steps.size())
+        {
+            return step.converter(value, currentValue);
+        }
+
+        value = step.converter(value, step.handler->InitValue());
+        if (!value.has_value())
+        {
+            return {};
+        }
+    }
+
+    return value;
+}
+
+
+TSys::TypeRegistry::TypeTable::TypeTable(const TypeTable& other)
+{
+    typeIds = other.typeIds;
+    hashIds = other.hashIds;
+    handlers = other.handlers;
+    apiNames = other.apiNames;
+    converterSets = other.converterSets;
+    revision = other.revision + 1;
+
+    // Views must be rebuilt against this table's own name storage,
+    // each one pointing into the name of the type that owns the entry.
+    for (const auto& name : apiNames)
+    {
+        auto byName = other.handlersByName.find(name.second);
+        if (byName == other.handlersByName.end())
+            continue;
+
+        auto id = typeIds.find(name.first);
+        if (id != typeIds.end() && handlers[id->second] == byName->second)
+        {
+            handlersByName.emplace(name.second, byName->second);
+        }
+    }
+}
+
+
+// Epoch based reclamation of registry tables: readers pin the
+// current epoch while they use tables, a retired table is freed once
+// no reader is pinned at or before the epoch it was retired at.
+namespace
+{
+    struct ReaderSlot
+    {
+        // Pinned epoch, 0 while the thread does not read.
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> used{false};
+        ReaderSlot* next = nullptr;
+    };
+
+
+    // Starts at 1 so that 0 can mean unpinned.
+    std::atomic<uint64_t> globalEpoch{1};
+
+    // Slots are never freed, they are reused once their thread exits.
+    std::atomic<ReaderSlot*> readerSlots{nullptr};
+
+
+    ReaderSlot* AcquireSlot()
+    {
+        for (ReaderSlot* slot = readerSlots.load(std::memory_order_acquire); slot; slot = slot->next)
+        {
+            bool used = false;
+            if (!slot->used.load(std::memory_order_relaxed) &&
+                slot->used.compare_exchange_strong(used, true, std::memory_order_acquire))
+            {
+                return slot;
+            }
+        }
+
+        auto slot = new ReaderSlot();
+        slot->used.store(true, std::memory_order_relaxed);
+
+        ReaderSlot* head = readerSlots.load(std::memory_order_relaxed);
+        do
+        {
+            slot->next = head;
+        }
+        while (!readerSlots.compare_exchange_weak(head, slot, std::memory_order_release,
+                                                  std::memory_order_relaxed));
+
+        return slot;
+    }
+
+
+    thread_local ReaderSlot* threadSlot = nullptr;
+
+    thread_local unsigned threadDepth = 0;
+
+
+    // Gives the slot of an exiting thread back.
+    struct SlotRelease
+    {
+        ~SlotRelease()
+        {
+            if (threadSlot)
+            {
+                threadSlot->epoch.store(0, std::memory_order_release);
+                threadSlot->used.store(false, std::memory_order_release);
+                threadSlot = nullptr;
+            }
+        }
+    };
+
+    thread_local SlotRelease threadRelease;
+
+
+    // Returns oldest epoch a reader is pinned at, or current epoch.
+    uint64_t OldestReaderEpoch()
+    {
+        uint64_t oldest = globalEpoch.load(std::memory_order_seq_cst);
+        for (ReaderSlot* slot = readerSlots.load(std::memory_order_acquire); slot; slot = slot->next)
+        {
+            uint64_t epoch = slot->epoch.load(std::memory_order_seq_cst);
+            if (epoch && epoch < oldest)
+            {
+                oldest = epoch;
+            }
+        }
+
+        return oldest;
+    }
+
+
+    template<class T>
+    void Retire(std::vector<std::pair<std::unique_ptr<const T>, uint64_t>>& retired,
+                std::unique_ptr<const T> value)
+    {
+        // Readers that loaded value are pinned at an epoch up to the
+        // one it is retired at, later ones cannot reach it anymore.
+        retired.emplace_back(std::move(value), globalEpoch.fetch_add(1, std::memory_order_seq_cst));
+
+        uint64_t oldest = OldestReaderEpoch();
+        retired.erase(
+                std::remove_if(retired.begin(), retired.end(),
+                               [oldest](const auto& entry) { return entry.second < oldest; }),
+                retired.end()
+        );
+    }
+}
+
+
+TSys::TypeRegistry::ReadGuard::ReadGuard()
+{
+    if (threadDepth++)
+    {
+        return;
+    }
+
+    if (!threadSlot)
+    {
+        threadSlot = AcquireSlot();
+        (void)&threadRelease;
+    }
+
+    // Pin has to be visible before tables are loaded, retiring
+    // threads scan pins after unpublishing. The fence alone orders
+    // the store, a sequentially consistent store would pay for a
+    // second full barrier on every lookup.
+    threadSlot->epoch.store(globalEpoch.load(std::memory_order_seq_cst), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+
+TSys::TypeRegistry::ReadGuard::~ReadGuard()
+{
+    if (--threadDepth)
+    {
+        return;
+    }
+
+    threadSlot->epoch.store(0, std::memory_order_release);
 }
 
 
 TSys::TypeRegistry::TypeRegistry()
 {
+    currentTable = std::make_unique<const TypeTable>();
+    table.store(currentTable.get(), std::memory_order_release);
+
     RegisterType<TSys::Enum, TSys::EnumHandler>();
+    RegisterType<TSys::EnumFlags, TSys::EnumFlagsHandler>();
     RegisterType<TSys::AnyValue, TSys::AnyHandler>();
     RegisterType<std::string, StringHandler>();
     RegisterType<bool, BoolHandler>();
@@ -61,19 +807,173 @@ bool TSys::TypeRegistry::RegisterType(
             bool force
 		)
 {
-    if (!force && handlers.find(t) != handlers.end())
+    std::lock_guard<std::mutex> lock(registerMutex);
+
+    const TypeTable& current = Table();
+    auto id = current.typeIds.find(t);
+    TypeHandlerPtr previous;
+    if (id != current.typeIds.end())
+    {
+        previous = current.handlers[id->second];
+    }
+
+    if (!force && previous)
     {
         return false;
     }
 
-    handlers[t] = handler;
+    if (previous)
+    {
+        previous->registeredId.store(InvalidTypeId, std::memory_order_release);
+    }
+
+    auto next = std::make_unique<TypeTable>(current);
+    TypeId typeId = AddTypeId(*next, t);
+
+    // Sources of conversions need an id to be part of conversion paths.
+    for (const auto& converter : handler->converters)
+    {
+        AddTypeId(*next, converter.first);
+    }
+
+    // Drop the previous name entry before its storage is replaced,
+    // unless another type has since claimed that name.
+    auto name = next->apiNames.find(t);
+    if (name != next->apiNames.end())
+    {
+        auto byName = next->handlersByName.find(name->second);
+        if (byName != next->handlersByName.end() && byName->second == previous)
+        {
+            next->handlersByName.erase(byName);
+        }
+    }
+
+    std::string& apiName = next->apiNames[t];
+    apiName = handler->ApiName();
+
+    next->handlers[typeId] = handler;
+
+    // An entry claimed from another type still has its key pointing
+    // into that type's name, it is keyed again on this one.
+    next->handlersByName.erase(apiName);
+    next->handlersByName.emplace(apiName, handler);
+    next->converterSets[typeId] = SnapshotConverters(*handler);
+    handler->registeredId.store(typeId, std::memory_order_release);
+
+    Publish(std::move(next));
     return true;
 }
 
 
+void TSys::TypeRegistry::Publish(std::unique_ptr<TypeTable> next)
+{
+    std::unique_ptr<const TypeTable> previous = std::move(currentTable);
+
+    currentTable = std::move(next);
+    table.store(currentTable.get(), std::memory_order_seq_cst);
+
+    Retire(retiredTables, std::move(previous));
+}
+
+
+std::shared_ptr<const TSys::ConverterSet> TSys::TypeRegistry::SnapshotConverters(const TypeHandler& handler)
+{
+    return std::make_shared<const ConverterSet>(
+            ConverterSet{handler.converters, handler.batchConverters}
+    );
+}
+
+
+void TSys::TypeRegistry::UpdateConverters(TypeHandler& handler, const std::function<void()>& update)
+{
+    std::lock_guard<std::mutex> lock(registerMutex);
+
+    update();
+
+    // Handler may have been replaced while waiting for the lock.
+    TypeId id = handler.Id();
+    if (id == InvalidTypeId)
+    {
+        return;
+    }
+
+    auto next = std::make_unique<TypeTable>(Table());
+    for (const auto& converter : handler.converters)
+    {
+        AddTypeId(*next, converter.first);
+    }
+
+    next->converterSets[id] = SnapshotConverters(handler);
+
+    Publish(std::move(next));
+}
+
+
+TSys::TypeId TSys::TypeRegistry::AddTypeId(TypeTable& t, const std::type_index& type)
+{
+    auto id = t.typeIds.find(type);
+    if (id != t.typeIds.end())
+    {
+        return id->second;
+    }
+
+    auto newId = static_cast<TypeId>(t.handlers.size());
+    t.typeIds[type] = newId;
+    t.hashIds[type.hash_code()] = newId;
+    t.handlers.emplace_back();
+    t.converterSets.emplace_back();
+
+    return newId;
+}
+
+
+TSys::TypeId TSys::TypeRegistry::ReserveTypeId(const std::type_index& t)
+{
+    TypeId id = GetTypeId(t);
+    if (id != InvalidTypeId)
+    {
+        return id;
+    }
+
+    std::lock_guard<std::mutex> lock(registerMutex);
+
+    // Another thread may have reserved it in the meantime, AddTypeId
+    // then only returns the existing id.
+    auto next = std::make_unique<TypeTable>(Table());
+    id = AddTypeId(*next, t);
+
+    Publish(std::move(next));
+    return id;
+}
+
+
+TSys::TypeId TSys::TypeRegistry::GetTypeId(const std::type_index& t) const
+{
+    ReadGuard guard;
+    const TypeTable& current = Table();
+    auto iter = current.typeIds.find(t);
+    if (iter == current.typeIds.end())
+        return InvalidTypeId;
+
+    return iter->second;
+}
+
+
+TSys::TypeId TSys::TypeRegistry::GetTypeIdByHash(size_t hash) const
+{
+    ReadGuard guard;
+    const TypeTable& current = Table();
+    auto iter = current.hashIds.find(hash);
+    if (iter == current.hashIds.end())
+        return InvalidTypeId;
+
+    return iter->second;
+}
+
+
 bool TSys::TypeRegistry::IsRegistered(const std::type_index& t) const
 {
-    return (handlers.find(t) != handlers.end());
+    return static_cast<bool>(GetTypeHandle(t));
 }
 
 
@@ -97,10 +997,12 @@ bool TSys::TypeRegistry::IsRegistered(const char* t) const
 
 std::vector<std::string> TSys::TypeRegistry::RegisteredTypes() const
 {
+    ReadGuard guard;
+
     std::vector<std::string> types;
-    for (const auto& handler : handlers)
+    for (const auto& name : Table().apiNames)
     {
-        types.push_back(handler.second->ApiName());
+        types.push_back(name.second);
     }
 
     return types;
@@ -115,11 +1017,7 @@ TSys::TypeHandlerPtr TSys::TypeRegistry::GetTypeHandle(const std::type_info& t)
 
 TSys::TypeHandlerPtr TSys::TypeRegistry::GetTypeHandle(const std::type_index& t) const
 {
-    auto iter = handlers.find(t);
-    if (iter == handlers.end())
-        return {};
-
-    return iter->second;
+    return GetTypeHandle(GetTypeId(t));
 }
 
 
@@ -131,38 +1029,275 @@ TSys::TypeHandlerPtr TSys::TypeRegistry::GetTypeHandle(const std::any& value) co
 
 TSys::TypeHandlerPtr TSys::TypeRegistry::GetTypeHandle(const std::string& name) const
 {
-    auto cmp = [name](
-            const std::pair<std::type_index, TypeHandlerPtr>& h
-    ) -> bool
-    {
-        return h.second->ApiName() == name;
-    };
+    return GetTypeHandle(std::string_view(name));
+}
+
+
+TSys::TypeHandlerPtr TSys::TypeRegistry::GetTypeHandle(const char* name) const
+{
+    return GetTypeHandle(std::string_view(name));
+}
 
-    auto h = std::find_if(handlers.begin(), handlers.end(), cmp);
 
-    if (h == handlers.end())
+TSys::TypeHandlerPtr TSys::TypeRegistry::GetTypeHandle(std::string_view name) const
+{
+    ReadGuard guard;
+    const TypeTable& current = Table();
+    auto iter = current.handlersByName.find(name);
+    if (iter == current.handlersByName.end())
         return {};
 
-    return h->second;
+    return iter->second;
 }
 
 
-TSys::TypeHandlerPtr TSys::TypeRegistry::GetTypeHandle(const char* name) const
+TSys::TypeHandlerPtr TSys::TypeRegistry::GetTypeHandle(TypeId id) const
+{
+    ReadGuard guard;
+    const TypeTable& current = Table();
+    if (id >= current.handlers.size())
+        return {};
+
+    return current.handlers[id];
+}
+
+
+TSys::TypeHandlerPtr TSys::TypeRegistry::GetTypeHandleByHash(size_t hash) const
 {
-    return GetTypeHandle(std::string(name));
+    return GetTypeHandle(GetTypeIdByHash(hash));
 }
 
 
-TSys::TypeRegistry* TSys::TypeRegistry::registry = nullptr;
+const TSys::TypeHandler* TSys::TypeRegistry::FindTypeHandle(TypeId id) const
+{
+    // Handlers are owned by the table, which the caller guard pins.
+    const TypeTable& current = Table();
+    if (id >= current.handlers.size())
+        return nullptr;
+
+    return current.handlers[id].get();
+}
 
 
-TSys::TypeRegistry* TSys::TypeRegistry::GetRegistry()
+const TSys::TypeHandler* TSys::TypeRegistry::FindTypeHandle(const std::type_index& t) const
+{
+    return FindTypeHandle(GetTypeId(t));
+}
+
+
+// Conversion matrix entry points.
+static std::any DirectConversion(const void* context, const std::any& sourceValue,
+                                 const std::any& currentValue)
+{
+    auto path = static_cast<const TSys::ConversionPath*>(context);
+    return path->steps.front().converter(sourceValue, currentValue);
+}
+
+
+static std::any PathConversion(const void* context, const std::any& sourceValue,
+                               const std::any& currentValue)
+{
+    auto path = static_cast<const TSys::ConversionPath*>(context);
+    return path->Convert(sourceValue, currentValue);
+}
+
+
+void TSys::TypeRegistry::BuildConversions(const TypeTable& types, ConversionTable& table)
+{
+    struct Edge
+    {
+        TypeId to;
+        const Converter* converter;
+    };
+
+    // Outgoing edges of each type, one per registered converter.
+    // Converters of a type from itself are kept apart, they never
+    // take part in longer paths.
+    std::vector<std::vector<Edge>> edges(types.handlers.size());
+    std::vector<const Converter*> self(types.handlers.size(), nullptr);
+    for (TypeId to = 0; to < types.handlers.size(); to++)
+    {
+        const auto& set = types.converterSets[to];
+        if (!types.handlers[to] || !set)
+            continue;
+
+        for (const auto& converter : set->converters)
+        {
+            auto from = types.typeIds.find(converter.first);
+            if (from == types.typeIds.end())
+                continue;
+
+            if (from->second == to)
+            {
+                self[to] = &converter.second;
+                continue;
+            }
+
+            edges[from->second].push_back({to, &converter.second});
+        }
+    }
+
+    // Breadth first search from every type gives the paths with the
+    // fewest conversions.
+    size_t count = types.handlers.size();
+    table.size = count;
+    table.paths.resize(count * count);
+    table.slots.resize(count * count);
+
+    for (TypeId from = 0; from < count; from++)
+    {
+        std::vector<TypeId> previous(count, InvalidTypeId);
+        std::vector<const Converter*> through(count, nullptr);
+        std::deque<TypeId> queue = {from};
+        previous[from] = from;
+
+        while (!queue.empty())
+        {
+            TypeId current = queue.front();
+            queue.pop_front();
+
+            if (current != from && !types.handlers[current]->CanConvertThrough())
+                continue;
+
+            for (const Edge& edge : edges[current])
+            {
+                if (previous[edge.to] != InvalidTypeId)
+                    continue;
+
+                previous[edge.to] = current;
+                through[edge.to] = edge.converter;
+                queue.push_back(edge.to);
+            }
+        }
+
+        // A type converts from itself through its own converter only.
+        if (self[from])
+        {
+            size_t index = from * count + from;
+            table.paths[index].steps.push_back({*self[from], types.handlers[from]});
+
+            ConversionSlot& slot = table.slots[index];
+            slot.function = DirectConversion;
+            slot.context = &table.paths[index];
+        }
+
+        for (TypeId to = 0; to < count; to++)
+        {
+            if (to == from || previous[to] == InvalidTypeId)
+                continue;
+
+            size_t index = from * count + to;
+            ConversionPath& path = table.paths[index];
+            for (TypeId step = to; step != from; step = previous[step])
+            {
+                path.steps.push_back({*through[step], types.handlers[step]});
+            }
+
+            std::reverse(path.steps.begin(), path.steps.end());
+
+            ConversionSlot& slot = table.slots[index];
+            slot.function = (path.steps.size() == 1) ? DirectConversion : PathConversion;
+            slot.context = &path;
+        }
+    }
+}
+
+
+const TSys::TypeRegistry::ConversionTable& TSys::TypeRegistry::Conversions() const
 {
-    if (!registry)
+    const TypeTable* types = &Table();
+
+    // Ids are stable, a table built for a newer revision also serves
+    // readers still using an older one.
+    const ConversionTable* current = conversions.load(std::memory_order_acquire);
+    if (current && current->typesRevision >= types->revision)
     {
-        registry = new TypeRegistry();
+        return *current;
     }
 
-    return registry;
+    std::lock_guard<std::mutex> lock(conversionMutex);
+
+    // Another thread may already have rebuilt it.
+    current = conversions.load(std::memory_order_acquire);
+    if (current && current->typesRevision >= types->revision)
+    {
+        return *current;
+    }
+
+    auto next = std::make_unique<ConversionTable>();
+    next->typesRevision = types->revision;
+    BuildConversions(*types, *next);
+
+    std::unique_ptr<const ConversionTable> previous = std::move(currentConversions);
+
+    currentConversions = std::move(next);
+    conversions.store(currentConversions.get(), std::memory_order_seq_cst);
+
+    if (previous)
+    {
+        Retire(retiredConversions, std::move(previous));
+    }
+
+    return *currentConversions;
+}
+
+
+const TSys::ConversionPath* TSys::TypeRegistry::GetConversionPath(TypeId from, TypeId to) const
+{
+    if (from == InvalidTypeId || to == InvalidTypeId)
+        return nullptr;
+
+    const ConversionTable& table = Conversions();
+    if (from >= table.size || to >= table.size)
+        return nullptr;
+
+    const ConversionPath& path = table.paths[from * table.size + to];
+    if (path.steps.empty())
+        return nullptr;
+
+    return &path;
+}
+
+
+const TSys::ConversionSlot* TSys::TypeRegistry::GetConversion(TypeId from, TypeId to) const
+{
+    if (from == InvalidTypeId || to == InvalidTypeId)
+        return nullptr;
+
+    const ConversionTable& table = Conversions();
+    if (from >= table.size || to >= table.size)
+        return nullptr;
+
+    const ConversionSlot& slot = table.slots[from * table.size + to];
+    if (!slot.function)
+        return nullptr;
+
+    return &slot;
 }
 
+
+TSys::BatchConverter TSys::TypeRegistry::GetBatchConverter(TypeId to, const std::type_index& from) const
+{
+    ReadGuard guard;
+
+    const auto& sets = Table().converterSets;
+    if (to >= sets.size() || !sets[to])
+        return {};
+
+    auto iter = sets[to]->batchConverters.find(from);
+    if (iter == sets[to]->batchConverters.end())
+        return {};
+
+    return iter->second;
+}
+
+
+TSys::TypeRegistry* TSys::TypeRegistry::GetRegistry()
+{
+    // Function local statics are initialized exactly once, even when
+    // several threads reach this point concurrently. The registry is
+    // intentionally never destroyed, handlers may be used during exit.
+    static TypeRegistry* registry = new TypeRegistry();
+
+    return registry;
+}
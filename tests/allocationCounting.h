@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+
+// Replaces the global operator new and delete of the test executable,
+// include from a single translation unit.
+// Every allocation of the process goes through these.
+static std::atomic<size_t> allocations{0};
+
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+
+// Runs function once to warm registry caches up, then returns the
+// allocations of a second run.
+template<class F>
+static size_t CountAllocations(F&& function)
+{
+    function();
+
+    size_t before = allocations.load(std::memory_order_relaxed);
+    function();
+
+    return allocations.load(std::memory_order_relaxed) - before;
+}
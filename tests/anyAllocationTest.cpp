@@ -0,0 +1,127 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+
+#include <string>
+
+#include "tests/testing.h"
+#include "tests/allocationCounting.h"
+
+
+// Wrapper paths only pay for the values they return.
+template<class T>
+static void CheckWrapped(const T& input)
+{
+    auto registry = TSys::TypeRegistry::GetRegistry();
+    auto anyHandler = registry->GetTypeHandle<TSys::AnyValue>();
+    auto handler = registry->GetTypeHandle<T>();
+
+    std::any wrapped = std::make_any<TSys::AnyValue>(TSys::AnyValue(input));
+    std::any other = std::make_any<TSys::AnyValue>(TSys::AnyValue(input));
+    const auto& value = std::any_cast<const TSys::AnyValue&>(wrapped);
+
+    TSYS_CHECK(CountAllocations([&]() { anyHandler->ValueHash(wrapped); }) == 0);
+
+    TSYS_CHECK(CountAllocations([&]() { TSYS_CHECK(anyHandler->CompareValue(wrapped, other)); }) == 0);
+
+    // Copy is the copy of the wrapper, nothing more.
+    size_t copy = CountAllocations([&]() { std::any result = std::make_any<TSys::AnyValue>(value); });
+    TSYS_CHECK(CountAllocations([&]() { std::any result = anyHandler->CopyValue(wrapped); }) == copy);
+
+    // Converting to the wrapped type is the copy of the wrapped value.
+    std::any current = handler->InitValue();
+    size_t held = CountAllocations([&]() { std::any result = value.Input(); });
+    TSYS_CHECK(CountAllocations([&]()
+    {
+        std::any result = TSys::AnyConverter()(wrapped, current);
+        TSYS_CHECK(std::any_cast<const T&>(result) == input);
+    }) == held);
+}
+
+
+// Converting to another type goes through the registry without
+// copying the wrapper.
+template<class T>
+static void CheckConverted(const T& input, int expected)
+{
+    std::any wrapped = std::make_any<TSys::AnyValue>(TSys::AnyValue(input));
+    std::any current = std::make_any<int>(0);
+
+    TSYS_CHECK(CountAllocations([&]()
+    {
+        std::any result = TSys::AnyConverter()(wrapped, current);
+        TSYS_CHECK(std::any_cast<int>(result) == expected);
+    }) == 0);
+}
+
+
+// Exposes the number of cached conversions.
+class CacheProbe: public TSys::AnyValue
+{
+public:
+    using TSys::AnyValue::AnyValue;
+
+    size_t Cached() const
+    {
+        return conversions.size();
+    }
+};
+
+
+// Cached conversions are returned in place.
+static void CheckCachedConversion()
+{
+    CacheProbe value(std::string("42"));
+    value.EnableConversionCache();
+
+    TSys::TypeId intId = TSys::TypeIdOf<int>();
+    const std::any& converted = value.ConvertToRef(intId);
+    TSYS_CHECK(std::any_cast<int>(converted) == 42);
+
+    TSYS_CHECK(CountAllocations([&]() { TSYS_CHECK(&value.ConvertToRef(intId) == &converted); }) == 0);
+
+    // Caching another conversion leaves the first one in place.
+    TSYS_CHECK(std::any_cast<double>(value.ConvertToRef(TSys::TypeIdOf<double>())) == 42.0);
+    TSYS_CHECK(&value.ConvertToRef(intId) == &converted);
+    TSYS_CHECK(value.Cached() == 2);
+
+    // Reading the held value keeps the cache, modifying it does not.
+    TSYS_CHECK(*value.CGetIf<std::string>() == "42");
+    TSYS_CHECK(value.CGetRef<std::string>() == "42");
+    TSYS_CHECK(value.Cached() == 2);
+
+    value.GetRef<std::string>() = "43";
+    TSYS_CHECK(value.Cached() == 0);
+    TSYS_CHECK(std::any_cast<int>(value.ConvertToRef(intId)) == 43);
+}
+
+
+// Failed conversions are not cached.
+static void CheckFailedConversion()
+{
+    CacheProbe value(std::string("not a number"));
+    value.EnableConversionCache();
+
+    TSys::TypeId intId = TSys::TypeIdOf<int>();
+    TSYS_CHECK(!value.ConvertTo(intId).has_value());
+    TSYS_CHECK(!value.ConvertToRef(intId).has_value());
+    TSYS_CHECK(value.Cached() == 0);
+}
+
+
+int main()
+{
+    // Long enough not to fit the small string storage.
+    std::string text = "a wrapped string, longer than the small string buffer";
+    TSys::Enum en(std::vector<std::string>{"first", "second", "third"}, 2);
+
+    CheckWrapped(text);
+    CheckWrapped(en);
+
+    CheckConverted(std::string("42"), 42);
+    CheckConverted(en, 2);
+
+    CheckCachedConversion();
+    CheckFailedConversion();
+
+    return 0;
+}
@@ -0,0 +1,287 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+#include "include/binary.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include "tests/testing.h"
+
+
+using Token = TSys::JsonReader::Token;
+using StringWriter = rapidjson::Writer<rapidjson::StringBuffer>;
+
+
+static TSys::TypeHandlerPtr AnyHandler()
+{
+    return TSys::TypeRegistry::GetRegistry()->GetTypeHandle<TSys::AnyValue>();
+}
+
+
+// Json text of an array holding the elements write streams.
+template<class F>
+static std::string WriteArray(F&& write)
+{
+    rapidjson::StringBuffer buffer;
+    StringWriter writer(buffer);
+    TSys::JsonWriterAdapter<StringWriter> adapter(writer);
+
+    writer.StartArray();
+    write(adapter);
+    writer.EndArray();
+
+    return buffer.GetString();
+}
+
+
+// Json text of a serialized array, numbers printed as streamed ones.
+static std::string WriteDocument(rapidjson::Value& array)
+{
+    return WriteArray([&](TSys::JsonWriter& writer)
+    {
+        for (auto& element : array.GetArray())
+        {
+            element.Accept(writer);
+        }
+    });
+}
+
+
+// Streamed value and construction are the serialized ones, byte for byte.
+static void CheckSameBytes(const TSys::TypeHandlerPtr& handler, const std::any& value)
+{
+    rapidjson::Document doc;
+
+    rapidjson::Value serialized(rapidjson::kArrayType);
+    handler->SerializeValue(value, serialized, doc);
+
+    std::string streamed = WriteArray([&](TSys::JsonWriter& writer) { handler->WriteValue(value, writer); });
+    TSYS_CHECK(streamed == WriteDocument(serialized));
+
+    rapidjson::Value construction(rapidjson::kArrayType);
+    handler->SerializeConstruction(value, construction, doc);
+
+    streamed = WriteArray([&](TSys::JsonWriter& writer) { handler->WriteConstruction(value, writer); });
+    TSYS_CHECK(streamed == WriteDocument(construction));
+}
+
+
+// Through the type handler, then wrapped in an Any value.
+template<class T>
+static void CheckStreamed(const T& input)
+{
+    CheckSameBytes(TSys::TypeRegistry::GetRegistry()->GetTypeHandle<T>(), std::make_any<T>(input));
+    CheckSameBytes(AnyHandler(), std::make_any<TSys::AnyValue>(TSys::AnyValue(input)));
+}
+
+
+// Streams construction then value in one array, reads both back.
+static std::any ReadBack(const TSys::TypeHandlerPtr& handler, const std::any& value)
+{
+    std::string json = WriteArray([&](TSys::JsonWriter& writer)
+    {
+        handler->WriteConstruction(value, writer);
+        handler->WriteValue(value, writer);
+    });
+
+    rapidjson::StringStream stream(json.c_str());
+    TSys::JsonReaderAdapter<rapidjson::StringStream, rapidjson::kParseFullPrecisionFlag> reader(stream);
+
+    TSYS_CHECK(reader.Next());
+    TSYS_CHECK(reader.Consume(Token::StartArray));
+
+    std::any construction = handler->ReadConstruction(reader);
+    std::any result = handler->ReadValue(construction, reader);
+
+    TSYS_CHECK(reader.Consume(Token::EndArray));
+    TSYS_CHECK(!reader.HasError());
+    TSYS_CHECK(result.type() == value.type());
+
+    return result;
+}
+
+
+template<class T>
+static T ReadBack(const T& input)
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<T>();
+
+    return std::any_cast<T>(ReadBack(handler, std::make_any<T>(input)));
+}
+
+
+static std::vector<std::string> Names(size_t count)
+{
+    std::vector<std::string> names;
+    for (size_t i = 0; i < count; i++)
+    {
+        names.push_back("v" + std::to_string(i));
+    }
+
+    return names;
+}
+
+
+// Flags over count entries, with first and last set.
+static TSys::EnumFlags Flags(size_t count)
+{
+    TSys::EnumFlags flags(Names(count));
+    flags.SetPosition(0);
+    flags.SetPosition(count - 1);
+
+    return flags;
+}
+
+
+// Constructions carry the definition, values select in it.
+static void CheckEnumReadBack()
+{
+    for (const auto& en : {TSys::Enum(std::vector<std::string>{"linear", "smooth", "step"}, 1),
+                           TSys::Enum(std::map<unsigned int, std::string>{{2, "low"}, {7, "high"}}, 7)})
+    {
+        TSys::Enum read = ReadBack(en);
+        TSYS_CHECK(read == en);
+        TSYS_CHECK(read.CurrentIndex() == en.CurrentIndex());
+        TSYS_CHECK(*read.Definition() == *en.Definition());
+    }
+
+    for (const auto& flags : {Flags(40), Flags(130)})
+    {
+        TSys::EnumFlags read = ReadBack(flags);
+        TSYS_CHECK(read == flags);
+        TSYS_CHECK(read.Indices() == flags.Indices());
+        TSYS_CHECK(*read.Definition() == *flags.Definition());
+    }
+}
+
+
+// Reads back the single element array written around an Any value.
+template<class T>
+static void CheckRead(TSys::JsonReader& reader, const T& input)
+{
+    auto handler = AnyHandler();
+
+    TSYS_CHECK(reader.Next());
+    TSYS_CHECK(reader.Consume(Token::StartArray));
+
+    std::any result = handler->ReadValue(handler->InitValue(), reader);
+
+    TSYS_CHECK(reader.Consume(Token::EndArray));
+    TSYS_CHECK(!reader.HasError());
+
+    const auto& value = std::any_cast<const TSys::AnyValue&>(result);
+    TSYS_CHECK(value.Is<T>());
+    TSYS_CHECK(value.GetRef<T>() == input);
+}
+
+
+template<class T>
+static void CheckJson(const T& input)
+{
+    auto handler = AnyHandler();
+    std::any value = std::make_any<TSys::AnyValue>(TSys::AnyValue(input));
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    TSys::JsonWriterAdapter<rapidjson::Writer<rapidjson::StringBuffer>> adapter(writer);
+
+    writer.StartArray();
+    handler->WriteValue(value, adapter);
+    writer.EndArray();
+
+    rapidjson::StringStream stream(buffer.GetString());
+    TSys::JsonReaderAdapter<rapidjson::StringStream> reader(stream);
+
+    CheckRead(reader, input);
+}
+
+
+template<class T>
+static void CheckBinary(const T& input)
+{
+    auto handler = AnyHandler();
+    std::any value = std::make_any<TSys::AnyValue>(TSys::AnyValue(input));
+
+    std::string data;
+    TSys::BinaryWriter writer(data);
+
+    writer.StartArray();
+    handler->WriteValue(value, writer);
+    writer.EndArray(0);
+
+    TSys::BinaryReader reader(data);
+
+    CheckRead(reader, input);
+}
+
+
+template<class T>
+static void CheckDocument(const T& input)
+{
+    auto handler = AnyHandler();
+    std::any value = std::make_any<TSys::AnyValue>(TSys::AnyValue(input));
+
+    rapidjson::Document doc;
+    rapidjson::Value json(rapidjson::kArrayType);
+    handler->SerializeValue(value, json, doc);
+
+    std::any result = handler->DeserializeValue(handler->InitValue(), json);
+
+    const auto& read = std::any_cast<const TSys::AnyValue&>(result);
+    TSYS_CHECK(read.Is<T>());
+    TSYS_CHECK(read.GetRef<T>() == input);
+}
+
+
+template<class T>
+static void CheckRoundTrip(const T& input)
+{
+    CheckJson(input);
+    CheckBinary(input);
+    CheckDocument(input);
+}
+
+
+int main()
+{
+    CheckRoundTrip(42);
+    CheckRoundTrip(1.25);
+    CheckRoundTrip(0.5f);
+    CheckRoundTrip(true);
+    CheckRoundTrip(std::string("wrapped string"));
+
+    CheckStreamed(42);
+    CheckStreamed(true);
+    CheckStreamed(std::string("streamed \"string\""));
+    CheckStreamed(-2.0);
+    CheckStreamed(0.1);
+    CheckStreamed(1e300);
+
+    // Documents store floats as doubles, only exact ones print the same.
+    CheckStreamed(1.5f);
+    CheckStreamed(-0.25f);
+
+    CheckStreamed(TSys::Enum(std::vector<std::string>{"linear", "smooth", "step"}, 1));
+    CheckStreamed(TSys::Enum(std::map<unsigned int, std::string>{{2, "low"}, {7, "high"}}, 7));
+    CheckStreamed(Flags(40));
+    CheckStreamed(Flags(130));
+
+    // Float and double constructions are their type name, values print
+    // shortest, read back exactly.
+    TSYS_CHECK(ReadBack(0.1f) == 0.1f);
+    TSYS_CHECK(ReadBack(-3.4e38f) == -3.4e38f);
+    TSYS_CHECK(ReadBack(0.1) == 0.1);
+    TSYS_CHECK(ReadBack(1.0 / 3.0) == 1.0 / 3.0);
+    TSYS_CHECK(ReadBack(5e-324) == 5e-324);
+    TSYS_CHECK(ReadBack(42) == 42);
+    TSYS_CHECK(ReadBack(std::string("read back")) == "read back");
+
+    CheckEnumReadBack();
+
+    return 0;
+}
@@ -0,0 +1,315 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+#include "include/archive.h"
+
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "tests/testing.h"
+
+
+// Archive footer, as laid out by ArchiveWriter.
+static constexpr size_t FooterSize = 8 + 8 + 8 + 8 + 4;
+
+static constexpr size_t IndexRecordSize = 8 + 4 + 8 + 8;
+
+// Long enough to count its occurrences in the archive.
+static const std::string LongName = "a value name long enough to only be found where it is written";
+
+
+// Exposes the bytes the reader decodes from.
+class ProbeReader: public TSys::ArchiveReader
+{
+public:
+    bool Mapped() const
+    {
+        return data && data == file.Data();
+    }
+
+    // View lies in the archive bytes.
+    bool Maps(std::string_view view) const
+    {
+        return view.data() >= data && view.data() + view.size() <= data + size;
+    }
+};
+
+
+// Copy of data sized exactly, so that reads past its end are caught
+// by address sanitizer or valgrind runs.
+static std::unique_ptr<char[]> Exact(const std::string& data, size_t size)
+{
+    std::unique_ptr<char[]> copy(new char[size ? size : 1]);
+    std::memcpy(copy.get(), data.data(), size);
+    return copy;
+}
+
+
+static uint64_t GetFixed(const std::string& data, size_t offset)
+{
+    uint64_t v = 0;
+    for (size_t i = 0; i < 8; i++)
+    {
+        v |= (uint64_t)(uint8_t)data[offset + i] << (8 * i);
+    }
+
+    return v;
+}
+
+
+static void SetFixed(std::string& data, size_t offset, uint64_t v)
+{
+    for (size_t i = 0; i < 8; i++)
+    {
+        data[offset + i] = (char)(v >> (8 * i));
+    }
+}
+
+
+static TSys::Enum Mode(unsigned int index)
+{
+    static const TSys::Enum mode(std::vector<std::string>{"linear", LongName, "step"});
+
+    return TSys::Enum(mode.Definition(), index);
+}
+
+
+static void Fill(TSys::ArchiveWriter& writer)
+{
+    TSys::EnumFlags flags(Mode(0));
+    flags.SetValue("step");
+
+    TSYS_CHECK(writer.Add("count", std::make_any<int>(3)));
+    TSYS_CHECK(writer.Add("name", std::make_any<std::string>("first")));
+    TSYS_CHECK(writer.Add("mode", std::make_any<TSys::Enum>(Mode(1))));
+    TSYS_CHECK(writer.Add("other", std::make_any<TSys::Enum>(Mode(2))));
+    TSYS_CHECK(writer.Add("flags", std::make_any<TSys::EnumFlags>(flags)));
+    TSYS_CHECK(writer.Add("ratio", std::make_any<double>(0.5)));
+
+    // Replaced, only the last value is indexed.
+    TSYS_CHECK(writer.Add("name", std::make_any<std::string>("second")));
+}
+
+
+static void CheckValues(const ProbeReader& reader)
+{
+    TSYS_CHECK(reader.Size() == 6);
+
+    const char* keys[] = {"count", "flags", "mode", "name", "other", "ratio"};
+    for (size_t i = 0; i < reader.Size(); i++)
+    {
+        TSYS_CHECK(reader.Key(i) == keys[i]);
+        TSYS_CHECK(reader.Maps(reader.Key(i)));
+        TSYS_CHECK(reader.Contains(keys[i]));
+    }
+
+    TSYS_CHECK(reader.Key(reader.Size()).empty());
+
+    auto registry = TSys::TypeRegistry::GetRegistry();
+    TSYS_CHECK(reader.TypeName("count") == registry->GetTypeHandle<int>()->ApiName());
+    TSYS_CHECK(reader.TypeName("mode") == registry->GetTypeHandle<TSys::Enum>()->ApiName());
+
+    TSYS_CHECK(std::any_cast<int>(reader.Value("count")) == 3);
+    TSYS_CHECK(std::any_cast<double>(reader.Value("ratio")) == 0.5);
+    TSYS_CHECK(std::any_cast<std::string>(reader.Value("name")) == "second");
+
+    // String views reference the archive bytes.
+    std::string_view name;
+    TSYS_CHECK(reader.StringView("name", name));
+    TSYS_CHECK(name == "second");
+    TSYS_CHECK(reader.Maps(name));
+    TSYS_CHECK(!reader.StringView("count", name));
+
+    // Enums read from the archive share the definition of its table.
+    auto mode = std::any_cast<TSys::Enum>(reader.Value("mode"));
+    auto other = std::any_cast<TSys::Enum>(reader.Value("other"));
+    auto flags = std::any_cast<TSys::EnumFlags>(reader.Value("flags"));
+
+    TSYS_CHECK(mode.CurrentValue() == LongName);
+    TSYS_CHECK(other.CurrentValue() == "step");
+    TSYS_CHECK(*mode.Definition() == *Mode(0).Definition());
+
+    TSYS_CHECK(mode.Definition() == other.Definition());
+    TSYS_CHECK(mode.Definition() == flags.Definition());
+    TSYS_CHECK(mode.Definition() == std::any_cast<TSys::Enum>(reader.Value("mode")).Definition());
+
+    TSYS_CHECK(flags.Count() == 2 && flags.TestValue("linear") && flags.TestValue("step"));
+}
+
+
+static void CheckAbsent(const ProbeReader& reader)
+{
+    // Before the first key, after the last, prefix and extension of a key.
+    for (std::string_view key : {"", "a", "zzz", "nam", "names", "count "})
+    {
+        TSYS_CHECK(!reader.Contains(key));
+        TSYS_CHECK(!reader.Value(key).has_value());
+        TSYS_CHECK(reader.TypeName(key).empty());
+
+        std::string_view value;
+        TSYS_CHECK(!reader.StringView(key, value));
+    }
+}
+
+
+static void CheckFile()
+{
+    auto path = (std::filesystem::temp_directory_path() / "tsysArchiveTest.tsa").string();
+
+    TSys::ArchiveWriter writer;
+    Fill(writer);
+    TSYS_CHECK(writer.Save(path));
+
+    {
+        ProbeReader reader;
+        TSYS_CHECK(reader.Open(path));
+        TSYS_CHECK(reader.Mapped());
+
+        CheckValues(reader);
+        CheckAbsent(reader);
+    }
+
+    // Saving replaces the whole file.
+    TSys::ArchiveWriter single;
+    TSYS_CHECK(single.Add("name", std::make_any<std::string>("first")));
+    TSYS_CHECK(single.Save(path));
+
+    {
+        ProbeReader reader;
+        TSYS_CHECK(reader.Open(path));
+        TSYS_CHECK(reader.Size() == 1);
+        TSYS_CHECK(std::any_cast<std::string>(reader.Value("name")) == "first");
+    }
+
+    std::filesystem::remove(path);
+
+    ProbeReader reader;
+    TSYS_CHECK(!reader.Open(path));
+}
+
+
+static void CheckMemory(const std::string& data)
+{
+    auto copy = Exact(data, data.size());
+
+    ProbeReader reader;
+    TSYS_CHECK(reader.Open(copy.get(), data.size()));
+    TSYS_CHECK(!reader.Mapped());
+
+    CheckValues(reader);
+    CheckAbsent(reader);
+
+    // Definitions are written once, in the enum table.
+    size_t written = 0;
+    for (size_t at = data.find(LongName); at != std::string::npos; at = data.find(LongName, at + 1))
+    {
+        written++;
+    }
+
+    TSYS_CHECK(written == 1);
+}
+
+
+static bool Opens(const std::string& data)
+{
+    auto copy = Exact(data, data.size());
+
+    ProbeReader reader;
+    return reader.Open(copy.get(), data.size());
+}
+
+
+static void CheckCorrupted(const std::string& data)
+{
+    TSYS_CHECK(Opens(data));
+
+    for (size_t size = 0; size < data.size(); size++)
+    {
+        TSYS_CHECK(!Opens(data.substr(0, size)));
+    }
+
+    size_t footer = data.size() - FooterSize;
+    uint64_t typeTableOffset = GetFixed(data, footer);
+    uint64_t enumTableOffset = GetFixed(data, footer + 8);
+    uint64_t indexOffset = GetFixed(data, footer + 16);
+    uint64_t entryCount = GetFixed(data, footer + 24);
+
+    TSYS_CHECK(typeTableOffset < enumTableOffset && enumTableOffset < indexOffset);
+    TSYS_CHECK(indexOffset + entryCount * IndexRecordSize == footer);
+
+    // Header and trailing magic, other versions.
+    auto corrupt = [&](size_t offset, char byte)
+    {
+        std::string copy = data;
+        copy[offset] = byte;
+        return copy;
+    };
+
+    TSYS_CHECK(!Opens(corrupt(0, 'X')));
+    TSYS_CHECK(!Opens(corrupt(4, 1)));
+    TSYS_CHECK(!Opens(corrupt(data.size() - 1, 'X')));
+
+    // Footer offsets out of order or past the index.
+    auto footerField = [&](size_t field, uint64_t v)
+    {
+        std::string copy = data;
+        SetFixed(copy, footer + 8 * field, v);
+        return copy;
+    };
+
+    TSYS_CHECK(!Opens(footerField(0, enumTableOffset + 1)));
+    TSYS_CHECK(!Opens(footerField(1, indexOffset + 1)));
+    TSYS_CHECK(!Opens(footerField(2, footer + 1)));
+    TSYS_CHECK(!Opens(footerField(2, ~uint64_t(0))));
+    TSYS_CHECK(!Opens(footerField(3, entryCount + 1)));
+    TSYS_CHECK(!Opens(footerField(3, entryCount - 1)));
+
+    // Type names running past the table, enum table holding a bad tag.
+    TSYS_CHECK(!Opens(corrupt(typeTableOffset, 0x7f)));
+    TSYS_CHECK(!Opens(corrupt(enumTableOffset, (char)0xff)));
+
+    // Index records are only checked when read, fields are the 8 byte
+    // key offset, entry offset and entry size.
+    auto record = [&](size_t i, size_t field, uint64_t v)
+    {
+        std::string copy = data;
+        SetFixed(copy, indexOffset + i * IndexRecordSize + field, v);
+        return copy;
+    };
+
+    auto reads = [](const std::string& copy, std::string_view key)
+    {
+        auto bytes = Exact(copy, copy.size());
+
+        ProbeReader reader;
+        TSYS_CHECK(reader.Open(bytes.get(), copy.size()));
+        return reader.Value(key).has_value();
+    };
+
+    TSYS_CHECK(reads(data, "count"));
+
+    // Record 0 is "count": key offset past the end, entry past the end,
+    // entry cut short.
+    TSYS_CHECK(!reads(record(0, 0, ~uint64_t(0)), "count"));
+    TSYS_CHECK(!reads(record(0, 12, data.size()), "count"));
+    TSYS_CHECK(!reads(record(0, 20, ~uint64_t(0)), "count"));
+    TSYS_CHECK(!reads(record(0, 20, 1), "count"));
+}
+
+
+int main()
+{
+    TSys::ArchiveWriter writer;
+    Fill(writer);
+
+    std::string data = writer.Data();
+
+    CheckFile();
+    CheckMemory(data);
+    CheckCorrupted(data);
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+#include "include/arena.h"
+
+#include <cstdlib>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include "tests/testing.h"
+#include "tests/allocationCounting.h"
+
+
+// Counts allocations, backed by the C heap so that they are not
+// counted as global allocations.
+class CountingResource: public std::pmr::memory_resource
+{
+public:
+    size_t allocations = 0;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        allocations++;
+
+        if (void* p = std::aligned_alloc(alignment, (bytes + alignment - 1) / alignment * alignment))
+        {
+            return p;
+        }
+
+        throw std::bad_alloc();
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override
+    {
+        std::free(p);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+
+// Last one does not fit the small string storage.
+static const std::vector<std::string> Names = {
+        "first", "second", "third", "a name longer than the small string buffer"
+};
+
+
+// Definition, entries and name index all live in resource.
+static void CheckDefinition(const TSys::EnumDefinitionPtr& definition,
+                            std::pmr::memory_resource* resource)
+{
+    TSYS_CHECK(definition && definition->Size() == Names.size());
+    TSYS_CHECK(definition->Values().get_allocator().resource() == resource);
+
+    for (size_t i = 0; i < Names.size(); i++)
+    {
+        TSYS_CHECK(std::string_view(definition->Values()[i].second) == Names[i]);
+        TSYS_CHECK(definition->Values()[i].second.get_allocator().resource() == resource);
+        TSYS_CHECK(definition->Find(Names[i]) == &definition->Values()[i]);
+    }
+}
+
+
+// Global allocations of holding a copy of value in a std::any, the
+// only ones deserializing through a resource may make.
+template<class T>
+static size_t Boxed(const std::any& value)
+{
+    return CountAllocations([&]() { std::any result = std::make_any<T>(std::any_cast<const T&>(value)); });
+}
+
+
+// Construction of T, written as json text.
+template<class T>
+static std::string ConstructionJson(const T& input)
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<T>();
+
+    rapidjson::Document doc;
+    rapidjson::Value json(rapidjson::kArrayType);
+    handler->SerializeConstruction(std::make_any<T>(input), json, doc);
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    json.Accept(writer);
+
+    return buffer.GetString();
+}
+
+
+template<class T>
+static void CheckResource()
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<T>();
+    std::string text = ConstructionJson(T(Names));
+
+    rapidjson::Document doc;
+    doc.Parse(text.c_str(), text.size());
+
+    CountingResource resource;
+    {
+        std::any result = handler->DeserializeConstruction(doc, &resource);
+        TSYS_CHECK(resource.allocations > 0);
+
+        CheckDefinition(std::any_cast<const T&>(result).Definition(), &resource);
+
+        TSYS_CHECK(CountAllocations([&]() { handler->DeserializeConstruction(doc, &resource); })
+                   == Boxed<T>(result));
+    }
+}
+
+
+template<class T>
+static void CheckArena()
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<T>();
+    std::string text = ConstructionJson(T(Names));
+
+    CountingResource upstream;
+    TSys::DeserializationArena arena(&upstream);
+
+    rapidjson::Document& doc = arena.Parse(text.c_str(), text.size());
+    TSYS_CHECK(upstream.allocations > 0);
+
+    // Values holding arena storage go before the arena is released.
+    size_t boxed = 0;
+    {
+        std::any result = arena.DeserializeConstruction(*handler, doc);
+        CheckDefinition(std::any_cast<const T&>(result).Definition(), arena.Resource());
+
+        boxed = Boxed<T>(result);
+    }
+
+    // Parsing and deserializing only allocate from the arena.
+    TSYS_CHECK(CountAllocations([&]()
+    {
+        rapidjson::Document& parsed = arena.Parse(text.c_str(), text.size());
+        std::any result = arena.DeserializeConstruction(*handler, parsed);
+    }) == boxed);
+
+    arena.Release();
+}
+
+
+static void CheckAny()
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<TSys::AnyValue>();
+
+    rapidjson::Document doc;
+    rapidjson::Value json(rapidjson::kArrayType);
+    handler->SerializeValue(std::make_any<TSys::AnyValue>(TSys::AnyValue(42)), json, doc);
+
+    CountingResource resource;
+    std::any result = handler->DeserializeValue(handler->InitValue(&resource), json, &resource);
+
+    const auto& value = std::any_cast<const TSys::AnyValue&>(result);
+    TSYS_CHECK(value.Is<int>());
+    TSYS_CHECK(value.GetRef<int>() == 42);
+}
+
+
+int main()
+{
+    CheckResource<TSys::Enum>();
+    CheckResource<TSys::EnumFlags>();
+
+    CheckArena<TSys::Enum>();
+    CheckArena<TSys::EnumFlags>();
+
+    CheckAny();
+
+    return 0;
+}
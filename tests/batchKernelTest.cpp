@@ -0,0 +1,165 @@
+#include "include/batchKernels.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "tests/testing.h"
+
+
+// Covers every tail length of the widest kernels, which convert
+// sixteen values per iteration, plus a few full blocks.
+static constexpr size_t MaxCount = 80;
+
+static const TSys::SimdLevel Levels[] = {
+        TSys::SimdLevel::Scalar,
+        TSys::SimdLevel::SSE2,
+        TSys::SimdLevel::AVX2,
+        TSys::SimdLevel::AVX512
+};
+
+
+// Deterministic pseudo random bits.
+static uint32_t Random()
+{
+    static uint32_t state = 0x12345678;
+    state = state * 1664525u + 1013904223u;
+    return state;
+}
+
+
+static std::vector<int> IntValues()
+{
+    std::vector<int> values = {
+            0, 1, -1, 7, -7, 16777217, -16777217, 123456789,
+            std::numeric_limits<int>::max(), std::numeric_limits<int>::min()
+    };
+
+    for (int i = 0; i < 32; i++)
+    {
+        values.push_back(static_cast<int>(Random()));
+    }
+
+    return values;
+}
+
+
+template<typename F>
+static std::vector<F> FloatingValues()
+{
+    std::vector<F> values = {
+            F(0), -F(0), F(0.5), F(-0.5), F(1.5), F(-2.5), F(0.1),
+            std::numeric_limits<F>::quiet_NaN(), -std::numeric_limits<F>::quiet_NaN(),
+            std::numeric_limits<F>::infinity(), -std::numeric_limits<F>::infinity(),
+            std::numeric_limits<F>::max(), std::numeric_limits<F>::lowest(),
+            std::numeric_limits<F>::denorm_min(), std::numeric_limits<F>::min(),
+            // Out of int range.
+            F(2147483648.0), F(-2147483904.0), F(1e20), F(-1e20),
+            F(2147483520.0), F(-2147483648.0)
+    };
+
+    if constexpr (sizeof(F) == sizeof(double))
+    {
+        // Out of float range, or rounded to float.
+        values.push_back(F(1e300));
+        values.push_back(F(-1e300));
+        values.push_back(F(1e-320));
+        values.push_back(F(16777217.0));
+        values.push_back(F(2147483647.0));
+    }
+
+    for (int i = 0; i < 32; i++)
+    {
+        values.push_back(static_cast<F>(static_cast<int>(Random())) / F(1000));
+    }
+
+    return values;
+}
+
+
+static std::vector<bool> BoolValues()
+{
+    std::vector<bool> values = {true, false, false, true, true};
+    for (int i = 0; i < 32; i++)
+    {
+        values.push_back(Random() & 1);
+    }
+
+    return values;
+}
+
+
+// Runs kernel at level on count values, results followed by one
+// guard element that must be left untouched.
+template<typename From, typename To>
+static bool Run(TSys::SimdLevel level, const From* sources, size_t count,
+                std::unique_ptr<unsigned char[]>& results)
+{
+    results.reset(new unsigned char[(count + 1) * sizeof(To)]);
+    std::memset(results.get(), 0xAB, (count + 1) * sizeof(To));
+
+    return TSys::BatchKernel<From, To>::RunAt(level, sources, reinterpret_cast<To*>(results.get()), count);
+}
+
+
+// Each level gives the same bits as the scalar kernel, for every
+// count, starting at every alignment.
+template<typename From, typename To, typename Values>
+static void CheckKernel(const Values& values)
+{
+    for (size_t count = 0; count <= MaxCount; count++)
+    {
+        for (size_t offset = 0; offset < 2; offset++)
+        {
+            std::unique_ptr<From[]> sources(new From[count + offset]);
+            for (size_t i = 0; i < count; i++)
+            {
+                sources[offset + i] = static_cast<From>(values[(i * 7 + count) % values.size()]);
+            }
+
+            std::unique_ptr<unsigned char[]> expected;
+            TSYS_CHECK((Run<From, To>(TSys::SimdLevel::Scalar, sources.get() + offset, count, expected)));
+
+            for (TSys::SimdLevel level : Levels)
+            {
+                std::unique_ptr<unsigned char[]> results;
+                if (!Run<From, To>(level, sources.get() + offset, count, results))
+                {
+                    // Level is not supported by this cpu.
+                    continue;
+                }
+
+                TSYS_CHECK(std::memcmp(results.get(), expected.get(), (count + 1) * sizeof(To)) == 0);
+            }
+        }
+    }
+}
+
+
+int main()
+{
+    auto ints = IntValues();
+    auto floats = FloatingValues<float>();
+    auto doubles = FloatingValues<double>();
+    auto bools = BoolValues();
+
+    CheckKernel<int, float>(ints);
+    CheckKernel<int, double>(ints);
+    CheckKernel<int, bool>(ints);
+
+    CheckKernel<float, int>(floats);
+    CheckKernel<float, double>(floats);
+    CheckKernel<float, bool>(floats);
+
+    CheckKernel<double, int>(doubles);
+    CheckKernel<double, float>(doubles);
+    CheckKernel<double, bool>(doubles);
+
+    CheckKernel<bool, int>(bools);
+    CheckKernel<bool, float>(bools);
+    CheckKernel<bool, double>(bools);
+
+    return 0;
+}
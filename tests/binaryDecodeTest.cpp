@@ -0,0 +1,229 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+#include "include/binary.h"
+
+#include <cstring>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "tests/testing.h"
+
+
+using Tag = TSys::Binary::Tag;
+using Token = TSys::JsonReader::Token;
+
+
+// Exposes the read position, to find token boundaries.
+class ProbeReader: public TSys::BinaryReader
+{
+public:
+    ProbeReader(const char* data, size_t size, const char* base):
+        TSys::BinaryReader(data, size),
+        base(base)
+    {
+
+    }
+
+    size_t Offset() const
+    {
+        return cursor - base;
+    }
+
+private:
+    const char* base;
+};
+
+
+// Copy of data sized exactly, so that reads past its end are caught
+// by address sanitizer or valgrind runs.
+static std::unique_ptr<char[]> Exact(const std::string& data, size_t size)
+{
+    std::unique_ptr<char[]> copy(new char[size ? size : 1]);
+    std::memcpy(copy.get(), data.data(), size);
+    return copy;
+}
+
+
+static std::string Header()
+{
+    std::string header(TSys::Binary::Magic, sizeof(TSys::Binary::Magic));
+    header.push_back((char)TSys::Binary::Version);
+    return header;
+}
+
+
+// One token of every kind, and a type name written twice.
+static std::string Document()
+{
+    std::string data;
+    TSys::BinaryWriter writer(data);
+
+    writer.StartArray();
+    writer.TypeName("Int");
+    writer.Null();
+    writer.Bool(true);
+    writer.Int(-5);
+    writer.Uint(7);
+    writer.Int64(-(int64_t(1) << 40));
+    writer.Uint64(uint64_t(1) << 63);
+    writer.Double(1.5);
+    writer.String("a string spanning a few bytes");
+    writer.RawNumber("12.5", 4, true);
+    writer.StartObject();
+    writer.Key("key", 3, true);
+    writer.TypeName("Int");
+    writer.EndObject(1);
+    writer.EndArray(0);
+
+    return data;
+}
+
+
+// Reads every token, returns number of tokens read.
+static size_t ReadAll(TSys::JsonReader& reader)
+{
+    size_t count = 0;
+    while (reader.Next())
+    {
+        count++;
+    }
+
+    return count;
+}
+
+
+// Every prefix either ends on a token boundary and reads the tokens
+// before it, or fails.
+static void CheckTruncated()
+{
+    std::string data = Document();
+
+    std::set<size_t> boundaries = {Header().size()};
+    std::vector<size_t> counts = {0};
+    {
+        ProbeReader reader(data.data(), data.size(), data.data());
+        while (reader.Next())
+        {
+            boundaries.insert(reader.Offset());
+            counts.push_back(counts.size());
+        }
+
+        TSYS_CHECK(!reader.HasError());
+        TSYS_CHECK(reader.Offset() == data.size());
+    }
+
+    for (size_t size = 0; size < data.size(); size++)
+    {
+        auto prefix = Exact(data, size);
+        TSys::BinaryReader reader(prefix.get(), size);
+
+        size_t count = ReadAll(reader);
+
+        auto boundary = boundaries.find(size);
+        if (boundary == boundaries.end())
+        {
+            TSYS_CHECK(reader.HasError());
+            continue;
+        }
+
+        TSYS_CHECK(!reader.HasError());
+        TSYS_CHECK(count == counts[std::distance(boundaries.begin(), boundary)]);
+    }
+}
+
+
+static bool Fails(const std::string& data)
+{
+    auto copy = Exact(data, data.size());
+    TSys::BinaryReader reader(copy.get(), data.size());
+
+    ReadAll(reader);
+    return reader.HasError();
+}
+
+
+static std::string Varint(uint64_t v)
+{
+    std::string bytes;
+    do
+    {
+        bytes.push_back((char)((v & 0x7f) | (v > 0x7f ? 0x80 : 0)));
+        v >>= 7;
+    } while (v);
+
+    return bytes;
+}
+
+
+static void CheckCorrupted()
+{
+    std::string header = Header();
+    TSYS_CHECK(!Fails(header));
+
+    // Header.
+    TSYS_CHECK(Fails("TSYX" + header.substr(4)));
+    TSYS_CHECK(Fails(header.substr(0, 4) + (char)(TSys::Binary::Version + 1)));
+
+    // Tags past the last one.
+    TSYS_CHECK(Fails(header + (char)((uint8_t)Tag::TypeReference + 1)));
+    TSYS_CHECK(Fails(header + (char)0xff));
+
+    // Varint longer than 64 bits.
+    TSYS_CHECK(Fails(header + (char)Tag::String + std::string(11, (char)0x80) + "abc"));
+
+    // Lengths past the end, including ones that wrap a pointer.
+    TSYS_CHECK(Fails(header + (char)Tag::String + Varint(4) + "abc"));
+    TSYS_CHECK(Fails(header + (char)Tag::Key + Varint(uint64_t(1) << 62) + "abc"));
+    TSYS_CHECK(Fails(header + (char)Tag::TypeDefinition + Varint(~uint64_t(0)) + "abc"));
+
+    // Type references to names not defined yet.
+    std::string definition = std::string(1, (char)Tag::TypeDefinition) + Varint(3) + "Int";
+    TSYS_CHECK(Fails(header + (char)Tag::TypeReference + Varint(0)));
+    TSYS_CHECK(!Fails(header + definition + (char)Tag::TypeReference + Varint(0)));
+    TSYS_CHECK(Fails(header + definition + (char)Tag::TypeReference + Varint(1)));
+    TSYS_CHECK(Fails(header + definition + (char)Tag::TypeReference + Varint(uint64_t(1) << 40)));
+}
+
+
+// Values read through handlers fail on every truncation.
+static void CheckValues()
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<TSys::AnyValue>();
+
+    TSys::Enum en(std::vector<std::string>{"first", "second", "third"}, 1);
+    std::any value = std::make_any<TSys::AnyValue>(TSys::AnyValue(en));
+
+    std::string data;
+    {
+        TSys::BinaryWriter writer(data);
+        writer.StartArray();
+        handler->WriteValue(value, writer);
+        writer.EndArray(0);
+    }
+
+    for (size_t size = 0; size < data.size(); size++)
+    {
+        auto prefix = Exact(data, size);
+        TSys::BinaryReader reader(prefix.get(), size);
+
+        if (reader.Next() && reader.Consume(Token::StartArray))
+        {
+            handler->ReadValue(handler->InitValue(), reader);
+            reader.Consume(Token::EndArray);
+        }
+
+        TSYS_CHECK(reader.HasError());
+    }
+}
+
+
+int main()
+{
+    CheckTruncated();
+    CheckCorrupted();
+    CheckValues();
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+#include "include/delta.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rapidjson/document.h"
+
+#include "tests/testing.h"
+
+
+typedef std::unordered_map<std::string, std::any> Values;
+
+
+static size_t Count(const rapidjson::Value& delta, const char* member)
+{
+    const rapidjson::Value& value = delta.FindMember(member)->value;
+    return value.IsObject() ? value.MemberCount() : value.Size();
+}
+
+
+// Applies delta onto both a base object and a value map.
+static void Apply(rapidjson::Value& delta, rapidjson::Value& base,
+                  rapidjson::Document& doc, Values& values)
+{
+    TSYS_CHECK(TSys::DeltaSerializer::Apply(delta, base, doc));
+    TSYS_CHECK(TSys::DeltaSerializer::Apply(delta, values));
+}
+
+
+// Value map read back from a base object, as a full load would.
+static Values Load(rapidjson::Value& base)
+{
+    Values values;
+    for (auto member = base.MemberBegin(); member != base.MemberEnd(); ++member)
+    {
+        std::any value = TSys::DeltaSerializer::ReadEntry(member->value);
+        TSYS_CHECK(value.has_value());
+
+        values[member->name.GetString()] = value;
+    }
+
+    return values;
+}
+
+
+static void CheckSaves()
+{
+    TSys::DeltaSerializer serializer;
+    rapidjson::Document doc;
+
+    rapidjson::Value base(rapidjson::kObjectType);
+    Values values;
+
+    // First save holds every slot.
+    std::vector<TSys::NamedValue> slots = {
+            {"count", std::make_any<int>(3)},
+            {"name", std::make_any<std::string>("first")},
+            {"ratio", std::make_any<double>(0.5)}
+    };
+
+    rapidjson::Value delta;
+    TSYS_CHECK(serializer.Serialize(slots, delta, doc) == 3);
+    TSYS_CHECK(Count(delta, "set") == 3 && Count(delta, "removed") == 0);
+    Apply(delta, base, doc, values);
+
+    TSYS_CHECK(values.size() == 3);
+    TSYS_CHECK(std::any_cast<int>(values["count"]) == 3);
+
+    // Unchanged slots are not written again.
+    TSYS_CHECK(serializer.Serialize(slots, delta, doc) == 0);
+    TSYS_CHECK(Count(delta, "set") == 0 && Count(delta, "removed") == 0);
+    Apply(delta, base, doc, values);
+
+    // Changed value.
+    slots[1].second = std::make_any<std::string>("second");
+    TSYS_CHECK(serializer.Serialize(slots, delta, doc) == 1);
+    TSYS_CHECK(delta.FindMember("set")->value.HasMember("name"));
+    Apply(delta, base, doc, values);
+
+    TSYS_CHECK(std::any_cast<std::string>(values["name"]) == "second");
+
+    // Changed type.
+    slots[0].second = std::make_any<float>(3.0f);
+    TSYS_CHECK(serializer.Serialize(slots, delta, doc) == 1);
+    TSYS_CHECK(delta.FindMember("set")->value.HasMember("count"));
+    Apply(delta, base, doc, values);
+
+    TSYS_CHECK(std::any_cast<float>(values["count"]) == 3.0f);
+
+    // Removed key.
+    slots.pop_back();
+    TSYS_CHECK(serializer.Serialize(slots, delta, doc) == 1);
+    TSYS_CHECK(Count(delta, "set") == 0 && Count(delta, "removed") == 1);
+    Apply(delta, base, doc, values);
+
+    TSYS_CHECK(values.size() == 2 && !values.count("ratio"));
+    TSYS_CHECK(!base.HasMember("ratio"));
+
+    // Base object reads back as the value map.
+    Values loaded = Load(base);
+    TSYS_CHECK(loaded.size() == 2);
+    TSYS_CHECK(std::any_cast<float>(loaded["count"]) == 3.0f);
+    TSYS_CHECK(std::any_cast<std::string>(loaded["name"]) == "second");
+
+    // Reset starts over with a full save.
+    serializer.Reset();
+    TSYS_CHECK(serializer.Serialize(slots, delta, doc) == 2);
+}
+
+
+static void CheckInvalid()
+{
+    rapidjson::Document doc;
+    doc.Parse("{\"set\": {\"key\": [\"Unknown\", [], []]}, \"removed\": [\"other\", 7]}");
+    TSYS_CHECK(!doc.HasParseError());
+
+    Values values = {{"other", std::make_any<int>(1)}, {"kept", std::make_any<int>(2)}};
+    TSYS_CHECK(!TSys::DeltaSerializer::Apply(doc, values));
+
+    // Valid parts are still applied.
+    TSYS_CHECK(values.size() == 1 && values.count("kept"));
+
+    rapidjson::Value base(rapidjson::kObjectType);
+    rapidjson::Value one(1);
+    base.AddMember(rapidjson::StringRef("other"), one, doc.GetAllocator());
+    TSYS_CHECK(!TSys::DeltaSerializer::Apply(doc, base, doc));
+    TSYS_CHECK(!base.HasMember("other") && base.HasMember("key"));
+
+    rapidjson::Value array(rapidjson::kArrayType);
+    TSYS_CHECK(!TSys::DeltaSerializer::Apply(array, values));
+}
+
+
+int main()
+{
+    CheckSaves();
+    CheckInvalid();
+
+    return 0;
+}
@@ -0,0 +1,510 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+#include "include/binary.h"
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "rapidjson/document.h"
+
+#include "tests/testing.h"
+#include "tests/allocationCounting.h"
+
+
+using Token = TSys::JsonReader::Token;
+
+
+static const std::vector<std::string> Modes = {"linear", "smooth", "step"};
+
+
+static rapidjson::Value Construction(const TSys::Enum& en, rapidjson::Document& doc)
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<TSys::Enum>();
+
+    rapidjson::Value construction(rapidjson::kArrayType);
+    handler->SerializeConstruction(std::make_any<TSys::Enum>(en), construction, doc);
+
+    return construction;
+}
+
+
+static TSys::Enum Construct(rapidjson::Value& construction)
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<TSys::Enum>();
+
+    return std::any_cast<TSys::Enum>(handler->DeserializeConstruction(construction));
+}
+
+
+// Shared and equal definitions are written once, as ids.
+static void CheckSchemaTable()
+{
+    rapidjson::Document doc;
+
+    TSys::Enum shared(Modes, 1);
+    TSys::Enum copy(shared.Definition(), 2);
+    TSys::Enum equal(Modes);
+    TSys::Enum other(std::vector<std::string>{"off", "on"});
+
+    TSys::EnumSchemaTable table;
+    std::vector<rapidjson::Value> constructions;
+    {
+        TSys::EnumSchemaScope scope(table);
+        TSYS_CHECK(TSys::EnumSchemaTable::Current() == &table);
+
+        for (const auto& en : {shared, copy, equal, other})
+        {
+            constructions.push_back(Construction(en, doc));
+        }
+    }
+
+    TSYS_CHECK(TSys::EnumSchemaTable::Current() == nullptr);
+    TSYS_CHECK(table.Size() == 2);
+
+    const int ids[] = {0, 0, 0, 1};
+    for (size_t i = 0; i < constructions.size(); i++)
+    {
+        TSYS_CHECK(constructions[i].Size() == 2);
+        TSYS_CHECK(constructions[i][1].IsInt() && constructions[i][1].GetInt() == ids[i]);
+    }
+
+    TSYS_CHECK(table.Definition(0) == shared.Definition());
+    TSYS_CHECK(*table.Definition(1) == *other.Definition());
+    TSYS_CHECK(table.Definition(2) == nullptr);
+
+    // Loaded table is shared by every construction referencing it.
+    rapidjson::Value serialized;
+    table.Serialize(serialized, doc);
+    TSYS_CHECK(serialized.IsArray() && serialized.Size() == 2);
+
+    TSys::EnumSchemaTable loaded;
+    TSYS_CHECK(loaded.Deserialize(serialized));
+    TSYS_CHECK(loaded.Size() == 2);
+
+    std::vector<TSys::Enum> enums;
+    {
+        TSys::EnumSchemaScope scope(loaded);
+        for (auto& construction : constructions)
+        {
+            enums.push_back(Construct(construction));
+        }
+    }
+
+    TSYS_CHECK(enums[0].Definition() == loaded.Definition(0));
+    TSYS_CHECK(enums[1].Definition() == enums[0].Definition());
+    TSYS_CHECK(enums[2].Definition() == enums[0].Definition());
+    TSYS_CHECK(enums[3].Definition() == loaded.Definition(1));
+
+    TSYS_CHECK(*enums[0].Definition() == *shared.Definition());
+    TSYS_CHECK(*enums[3].Definition() == *other.Definition());
+
+    // Streamed table, same definitions.
+    std::string data;
+    {
+        TSys::BinaryWriter writer(data);
+        table.Write(writer);
+    }
+
+    TSys::EnumSchemaTable streamed;
+    TSys::BinaryReader reader(data);
+    TSYS_CHECK(reader.Next() && streamed.Read(reader));
+    TSYS_CHECK(reader.Type() == Token::End && !reader.HasError());
+
+    TSYS_CHECK(streamed.Size() == 2);
+    TSYS_CHECK(*streamed.Definition(0) == *shared.Definition());
+    TSYS_CHECK(*streamed.Definition(1) == *other.Definition());
+
+    // Invalid tables are rejected and left empty.
+    rapidjson::Value invalid(rapidjson::kArrayType);
+    rapidjson::Value odd(rapidjson::kArrayType);
+    odd.PushBack(rapidjson::Value().SetInt(0), doc.GetAllocator());
+    invalid.PushBack(odd, doc.GetAllocator());
+
+    TSYS_CHECK(!loaded.Deserialize(invalid));
+    TSYS_CHECK(loaded.Size() == 0);
+}
+
+
+static void CheckNestedScopes()
+{
+    TSys::EnumSchemaTable outer;
+    TSys::EnumSchemaTable inner;
+    {
+        TSys::EnumSchemaScope outerScope(outer);
+        {
+            TSys::EnumSchemaScope innerScope(inner);
+            TSYS_CHECK(TSys::EnumSchemaTable::Current() == &inner);
+        }
+
+        TSYS_CHECK(TSys::EnumSchemaTable::Current() == &outer);
+    }
+
+    TSYS_CHECK(TSys::EnumSchemaTable::Current() == nullptr);
+}
+
+
+// Without table, definitions are written in full, and ids read back
+// as empty enums.
+static void CheckWithoutTable()
+{
+    rapidjson::Document doc;
+
+    TSys::Enum en(Modes, 2);
+    rapidjson::Value construction = Construction(en, doc);
+    TSYS_CHECK(construction.Size() == 1 + 2 * Modes.size());
+
+    TSys::Enum read = Construct(construction);
+    TSYS_CHECK(*read.Definition() == *en.Definition());
+    TSYS_CHECK(read.Definition() != en.Definition());
+
+    TSys::EnumSchemaTable table;
+    {
+        TSys::EnumSchemaScope scope(table);
+        construction = Construction(en, doc);
+    }
+
+    TSYS_CHECK(construction.Size() == 2);
+    TSYS_CHECK(Construct(construction).Definition()->Size() == 0);
+
+    // Ids past the table read back as empty enums too.
+    {
+        TSys::EnumSchemaScope scope(table);
+        construction[1].SetInt(5);
+        TSYS_CHECK(Construct(construction).Definition()->Size() == 0);
+    }
+}
+
+
+// Copies share the definition, adding a value copies it first.
+static void CheckCopyOnWrite()
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<TSys::Enum>();
+
+    TSys::Enum en(Modes, 1);
+    TSys::Enum copy = en;
+    TSYS_CHECK(copy.Definition() == en.Definition());
+
+    std::any value = handler->CopyValue(std::make_any<TSys::Enum>(en));
+    TSYS_CHECK(std::any_cast<const TSys::Enum&>(value).Definition() == en.Definition());
+
+    auto definition = en.Definition();
+    copy.AddValue(7, "constant");
+
+    TSYS_CHECK(copy.Definition() != en.Definition());
+    TSYS_CHECK(en.Definition() == definition);
+    TSYS_CHECK(en.Definition()->Size() == Modes.size() && !en.Definition()->Find(7));
+
+    TSYS_CHECK(copy.Definition()->Size() == Modes.size() + 1);
+    TSYS_CHECK(copy.CurrentIndex() == 1 && copy.CurrentValue() == "smooth");
+    TSYS_CHECK(copy.SetCurrentValue("constant") && copy.CurrentIndex() == 7);
+    TSYS_CHECK(!en.SetCurrentValue("constant") && en.CurrentIndex() == 1);
+}
+
+
+// Definitions copied or assigned index their own names.
+static void CheckDefinitionCopy()
+{
+    // Unsorted, index 4 duplicated: last one wins.
+    std::pmr::vector<TSys::EnumDefinition::Entry> entries;
+    entries.emplace_back(4, "four");
+    entries.emplace_back(1, "one");
+    entries.emplace_back(4, "other four");
+    entries.emplace_back(2, "a name too long for the small string buffer");
+
+    auto definition = std::make_unique<TSys::EnumDefinition>(std::move(entries));
+    TSYS_CHECK(definition->Size() == 3);
+    TSYS_CHECK(definition->Values()[0].first == 1 && definition->Values()[2].first == 4);
+    TSYS_CHECK(definition->Find(4)->second == "other four");
+    TSYS_CHECK(!definition->Find(std::string_view("four")));
+
+    TSys::EnumDefinition copy(*definition);
+
+    TSys::EnumDefinition assigned(Modes);
+    assigned = *definition;
+
+    // Original is gone, lookups only reach storage of the copies.
+    TSys::EnumDefinition expected(*definition);
+    definition.reset();
+
+    for (const TSys::EnumDefinition* d : {&copy, &assigned})
+    {
+        TSYS_CHECK(*d == expected && d->Hash() == expected.Hash());
+
+        for (const auto& entry : d->Values())
+        {
+            const TSys::EnumDefinition::Entry* found = d->Find(std::string_view(entry.second));
+            TSYS_CHECK(found == &entry);
+            TSYS_CHECK(d->Find(entry.first) == &entry);
+        }
+
+        TSYS_CHECK(!d->Find(std::string_view("linear")));
+        TSYS_CHECK(d->Position(3) == d->Size());
+    }
+}
+
+
+// Equality, hashes and name lookups only read definitions.
+static void CheckAllocationFree()
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<TSys::Enum>();
+
+    // Names past the small string buffer, which a copy would allocate.
+    const std::vector<std::string> names = {"linear", "a name too long for the small string buffer"};
+
+    TSys::Enum en(names, 1);
+    TSys::Enum shared(en.Definition(), 1);
+    TSys::Enum equal(names, 1);
+    TSys::Enum other(names, 0);
+
+    std::any value = std::make_any<TSys::Enum>(en);
+    std::any equalValue = std::make_any<TSys::Enum>(equal);
+    std::any otherValue = std::make_any<TSys::Enum>(other);
+
+    const std::string name = "linear";
+    const std::string_view longName = names[1];
+
+    bool equals = false;
+    TSYS_CHECK(CountAllocations([&]() { equals = en == shared && en == equal && !(en == other); }) == 0);
+    TSYS_CHECK(equals);
+
+    TSYS_CHECK(CountAllocations([&]()
+    {
+        equals = handler->CompareValue(value, equalValue) && !handler->CompareValue(value, otherValue);
+    }) == 0);
+    TSYS_CHECK(equals);
+
+    size_t hash = 0;
+    size_t equalHash = 0;
+    size_t otherHash = 0;
+    TSYS_CHECK(CountAllocations([&]()
+    {
+        hash = handler->ValueHash(value);
+        equalHash = handler->ValueHash(equalValue);
+        otherHash = handler->ValueHash(otherValue);
+    }) == 0);
+
+    TSYS_CHECK(hash == equalHash && hash != otherHash);
+    TSYS_CHECK(en.Definition()->Hash() == equal.Definition()->Hash());
+
+    const TSys::EnumDefinition::Entry* entry = nullptr;
+    TSYS_CHECK(CountAllocations([&]() { entry = en.Definition()->Find(longName); }) == 0);
+    TSYS_CHECK(entry && entry->first == 1);
+
+    TSYS_CHECK(CountAllocations([&]() { other.SetCurrentValue(name); }) == 0);
+    TSYS_CHECK(other.CurrentIndex() == 0 && !(other == en));
+}
+
+
+static std::vector<std::string> Names(size_t count)
+{
+    std::vector<std::string> names;
+    for (size_t i = 0; i < count; i++)
+    {
+        names.push_back("v" + std::to_string(i));
+    }
+
+    return names;
+}
+
+
+// Bits past the inline word spill to heap words.
+static void CheckFlagsSpill()
+{
+    TSys::EnumFlags inlined(Names(TSys::EnumFlags::WordBits));
+    TSYS_CHECK(inlined.WordCount() == 1);
+    TSYS_CHECK(inlined.SetPosition(63) && !inlined.SetPosition(64));
+    TSYS_CHECK(inlined.Word(0) == uint64_t(1) << 63);
+
+    TSys::EnumFlags flags(Names(130));
+    TSYS_CHECK(flags.Size() == 130 && flags.WordCount() == 3);
+    TSYS_CHECK(flags.None());
+
+    for (size_t position : {0, 63, 64, 129})
+    {
+        TSYS_CHECK(flags.SetPosition(position));
+    }
+
+    TSYS_CHECK(!flags.SetPosition(130));
+    TSYS_CHECK(flags.Count() == 4);
+    TSYS_CHECK(flags.Word(0) == (uint64_t(1) | uint64_t(1) << 63));
+    TSYS_CHECK(flags.Word(1) == 1 && flags.Word(2) == 2);
+    TSYS_CHECK(flags.Test(129) && flags.TestValue("v64") && !flags.TestValue("v65"));
+    TSYS_CHECK((flags.Indices() == std::vector<unsigned int>{0, 63, 64, 129}));
+
+    // Bits past the last entry are dropped.
+    flags.SetWord(2, ~uint64_t(0));
+    TSYS_CHECK(flags.Word(2) == 3 && flags.Count() == 5);
+
+    TSys::EnumFlags copy = flags;
+    TSYS_CHECK(copy == flags && copy.Hash() == flags.Hash());
+
+    copy.Reset(128);
+    TSYS_CHECK(copy != flags && copy.Count() == 4);
+
+    copy.Clear();
+    TSYS_CHECK(copy.None() && copy.Word(1) == 0 && copy.Word(2) == 0);
+}
+
+
+static std::any Flags(const TSys::EnumFlags& flags)
+{
+    return std::make_any<TSys::EnumFlags>(flags);
+}
+
+
+// Packed integer up to 64 entries, bit string past them, through the
+// DOM and streaming paths.
+static void CheckFlagsSerialization()
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<TSys::EnumFlags>();
+
+    TSys::EnumFlags packed(Names(40));
+    packed.SetPosition(1);
+    packed.SetPosition(39);
+
+    TSys::EnumFlags spilled(Names(130));
+    spilled.SetPosition(2);
+    spilled.SetPosition(129);
+
+    for (const auto& flags : {packed, spilled})
+    {
+        rapidjson::Document doc;
+        rapidjson::Value value(rapidjson::kArrayType);
+        handler->SerializeValue(Flags(flags), value, doc);
+
+        TSYS_CHECK(value.Size() == 2);
+        if (flags.Size() <= TSys::EnumFlags::WordBits)
+        {
+            TSYS_CHECK(value[1].IsUint64() && value[1].GetUint64() == flags.Word(0));
+        }
+        else
+        {
+            TSYS_CHECK(value[1].IsString() && value[1].GetStringLength() == flags.Size());
+            TSYS_CHECK(value[1].GetString()[2] == '1' && value[1].GetString()[3] == '0');
+            TSYS_CHECK(value[1].GetString()[129] == '1');
+        }
+
+        std::any construction = Flags(TSys::EnumFlags(flags.Definition()));
+        TSYS_CHECK(std::any_cast<TSys::EnumFlags>(handler->DeserializeValue(construction, value)) == flags);
+
+        std::string data;
+        {
+            TSys::BinaryWriter writer(data);
+            writer.StartArray();
+            handler->WriteValue(Flags(flags), writer);
+            writer.EndArray(0);
+        }
+
+        TSys::BinaryReader reader(data);
+        TSYS_CHECK(reader.Next() && reader.Consume(Token::StartArray));
+
+        std::any read = handler->ReadValue(construction, reader);
+        TSYS_CHECK(reader.Consume(Token::EndArray) && !reader.HasError());
+        TSYS_CHECK(std::any_cast<TSys::EnumFlags>(read) == flags);
+    }
+}
+
+
+// Flags of other definitions are matched by name.
+static void CheckFlagsCombination()
+{
+    TSys::EnumFlags first(std::vector<std::string>{"a", "b", "c"});
+    first.SetValue("a");
+    first.SetValue("b");
+
+    TSys::EnumFlags second(std::vector<std::string>{"c", "b", "d"});
+    second.SetValue("c");
+    second.SetValue("d");
+
+    TSys::EnumFlags combined = first | second;
+    TSYS_CHECK(combined.Definition() == first.Definition());
+    TSYS_CHECK((combined.Values() == std::vector<std::string>{"a", "b", "c"}));
+
+    TSYS_CHECK((first & second).None());
+    TSYS_CHECK(((first ^ combined).Values() == std::vector<std::string>{"c"}));
+
+    // Equal definitions compare bits, values missing from the
+    // definition make flags differ.
+    TSys::EnumFlags equal(std::vector<std::string>{"a", "b", "c"});
+    equal.SetValue("a");
+    equal.SetValue("b");
+    TSYS_CHECK(equal == first && equal.Hash() == first.Hash());
+
+    TSys::EnumFlags onlyC(first.Definition());
+    onlyC.SetValue("c");
+    TSYS_CHECK(onlyC != second);
+
+    // Empty flags take the definition of other.
+    TSys::EnumFlags empty;
+    empty |= second;
+    TSYS_CHECK(empty.Definition() == second.Definition() && empty == second);
+}
+
+
+static void CheckFlagsConversions()
+{
+    auto registry = TSys::TypeRegistry::GetRegistry();
+    auto flagsHandler = registry->GetTypeHandle<TSys::EnumFlags>();
+    auto intHandler = registry->GetTypeHandle<int>();
+    auto stringHandler = registry->GetTypeHandle<std::string>();
+    auto enumHandler = registry->GetTypeHandle<TSys::Enum>();
+
+    TSys::EnumFlags flags(std::vector<std::string>{"a", "b", "c"});
+    flags.SetValue("a");
+    flags.SetValue("c");
+
+    std::any result = intHandler->ConvertFrom(Flags(flags), intHandler->InitValue());
+    TSYS_CHECK(std::any_cast<int>(result) == 5);
+
+    result = stringHandler->ConvertFrom(Flags(flags), stringHandler->InitValue());
+    TSYS_CHECK(std::any_cast<std::string>(result) == "a|c");
+
+    TSys::EnumFlags target(flags.Definition());
+    result = flagsHandler->ConvertFrom(std::make_any<int>(6), Flags(target));
+    TSYS_CHECK((std::any_cast<TSys::EnumFlags>(result).Values() == std::vector<std::string>{"b", "c"}));
+
+    result = flagsHandler->ConvertFrom(std::make_any<std::string>(" c | a "), Flags(target));
+    TSYS_CHECK(std::any_cast<TSys::EnumFlags>(result) == flags);
+
+    // Enums convert to the first set value, and back to a single value.
+    result = enumHandler->ConvertFrom(Flags(flags), enumHandler->InitValue());
+    TSYS_CHECK(std::any_cast<TSys::Enum>(result).CurrentValue() == "a");
+
+    result = flagsHandler->ConvertFrom(std::make_any<TSys::Enum>(TSys::Enum(flags.Definition(), 1)),
+                                       flagsHandler->InitValue());
+    TSYS_CHECK((std::any_cast<TSys::EnumFlags>(result).Values() == std::vector<std::string>{"b"}));
+
+    // Bits past the 32 an int holds do not convert.
+    TSys::EnumFlags wide(Names(130));
+    wide.SetPosition(31);
+    TSYS_CHECK(std::any_cast<int>(intHandler->ConvertFrom(Flags(wide), intHandler->InitValue())) ==
+               (int)(uint32_t(1) << 31));
+
+    for (size_t position : {32, 63, 64, 129})
+    {
+        TSys::EnumFlags overflow(wide.Definition());
+        overflow.SetPosition(position);
+        TSYS_CHECK(!intHandler->ConvertFrom(Flags(overflow), intHandler->InitValue()).has_value());
+    }
+}
+
+
+int main()
+{
+    CheckSchemaTable();
+    CheckNestedScopes();
+    CheckWithoutTable();
+    CheckCopyOnWrite();
+    CheckDefinitionCopy();
+    CheckAllocationFree();
+    CheckFlagsSpill();
+    CheckFlagsSerialization();
+    CheckFlagsCombination();
+    CheckFlagsConversions();
+
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+#include "include/parallel.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rapidjson/document.h"
+
+#include "tests/testing.h"
+
+
+// Above the count SerializeValues starts threads at, and not a multiple
+// of any chunk count.
+static constexpr size_t ValueCount = 4 * 1024 + 17;
+
+static const unsigned int ThreadCounts[] = {0, 2, 3, 4, 8, 64};
+
+
+// Int handler throwing on negative values.
+struct ThrowingHandler: TSys::IntHandler
+{
+    void WriteValue(const std::any& v, TSys::JsonWriter& writer) const override
+    {
+        if (std::any_cast<int>(v) < 0)
+        {
+            throw std::runtime_error("negative value");
+        }
+
+        TSys::IntHandler::WriteValue(v, writer);
+    }
+};
+
+
+// Values of every default type, and values without handler.
+static std::vector<TSys::HandlerValue> Values(size_t count)
+{
+    auto registry = TSys::TypeRegistry::GetRegistry();
+
+    TSys::Enum en(std::vector<std::string>{"linear", "smooth", "step"}, 1);
+
+    std::vector<TSys::HandlerValue> values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        switch (i % 7)
+        {
+            case 0:
+                values.emplace_back(registry->GetTypeHandle<int>(), std::make_any<int>((int)i));
+                break;
+
+            case 1:
+                values.emplace_back(registry->GetTypeHandle<double>(), std::make_any<double>(i * 0.25));
+                break;
+
+            case 2:
+                values.emplace_back(registry->GetTypeHandle<std::string>(),
+                                    std::make_any<std::string>("value " + std::to_string(i)));
+                break;
+
+            case 3:
+                values.emplace_back(registry->GetTypeHandle<bool>(), std::make_any<bool>(i % 2 == 0));
+                break;
+
+            case 4:
+                values.emplace_back(registry->GetTypeHandle<TSys::Enum>(), std::make_any<TSys::Enum>(en));
+                break;
+
+            case 5:
+                values.emplace_back(registry->GetTypeHandle<TSys::AnyValue>(),
+                                    std::make_any<TSys::AnyValue>(TSys::AnyValue((float)i)));
+                break;
+
+            default:
+                values.emplace_back(nullptr, std::make_any<int>((int)i));
+                break;
+        }
+    }
+
+    return values;
+}
+
+
+static void CheckOrder()
+{
+    std::vector<TSys::HandlerValue> values = Values(ValueCount);
+
+    std::string expected = TSys::SerializeValues(values, 1);
+
+    rapidjson::Document doc;
+    doc.Parse(expected.c_str());
+    TSYS_CHECK(!doc.HasParseError());
+    TSYS_CHECK(doc.IsArray() && doc.Size() == ValueCount);
+    TSYS_CHECK(doc[6].IsArray() && doc[6].Size() == 0);
+
+    for (unsigned int threads : ThreadCounts)
+    {
+        TSYS_CHECK(TSys::SerializeValues(values, threads) == expected);
+    }
+
+    // Below the parallel count, and empty.
+    values.resize(100);
+    expected = TSys::SerializeValues(values, 1);
+    TSYS_CHECK(TSys::SerializeValues(values, 8) == expected);
+
+    values.clear();
+    TSYS_CHECK(TSys::SerializeValues(values, 1) == "[]");
+    TSYS_CHECK(TSys::SerializeValues(values, 8) == "[]");
+}
+
+
+static void CheckNullHandlers()
+{
+    std::vector<TSys::HandlerValue> values(ValueCount, TSys::HandlerValue(nullptr, std::any()));
+
+    std::string expected = "[";
+    for (size_t i = 0; i < ValueCount; i++)
+    {
+        expected += i ? ",[]" : "[]";
+    }
+
+    expected += "]";
+
+    for (unsigned int threads : ThreadCounts)
+    {
+        TSYS_CHECK(TSys::SerializeValues(values, threads) == expected);
+    }
+
+    TSYS_CHECK(TSys::SerializeValues(values, 1) == expected);
+}
+
+
+// Exceptions of any chunk reach the caller, once workers joined.
+static void CheckThrowing()
+{
+    auto handler = std::make_shared<ThrowingHandler>();
+
+    std::vector<TSys::HandlerValue> values = Values(ValueCount);
+    for (size_t i : {size_t(0), ValueCount / 2, ValueCount - 1})
+    {
+        std::vector<TSys::HandlerValue> throwing = values;
+        throwing[i] = TSys::HandlerValue(handler, std::make_any<int>(-1));
+
+        for (unsigned int threads : {1u, 2u, 4u, 8u})
+        {
+            bool thrown = false;
+            try
+            {
+                TSys::SerializeValues(throwing, threads);
+            }
+            catch (const std::runtime_error& error)
+            {
+                thrown = std::string(error.what()) == "negative value";
+            }
+
+            TSYS_CHECK(thrown);
+        }
+    }
+
+    // Handler writes as an int handler otherwise.
+    values[10] = TSys::HandlerValue(handler, std::make_any<int>(10));
+    TSYS_CHECK(TSys::SerializeValues(values, 4) == TSys::SerializeValues(values, 1));
+}
+
+
+int main()
+{
+    CheckOrder();
+    CheckNullHandlers();
+    CheckThrowing();
+
+    return 0;
+}
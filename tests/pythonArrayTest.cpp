@@ -0,0 +1,206 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+
+#include <boost/python.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "tests/testing.h"
+
+
+namespace python = boost::python;
+
+
+// Exit code ctest reports as skipped, see SKIP_RETURN_CODE.
+static constexpr int SkipCode = 77;
+
+
+static python::object Eval(const std::string& expression, python::object& scope)
+{
+    return python::eval(python::str(expression), scope, scope);
+}
+
+
+static bool True(const std::string& expression, python::object& scope)
+{
+    return python::extract<bool>(Eval("bool(" + expression + ")", scope));
+}
+
+
+template<class H, class T>
+static bool Read(const H& handler, const std::string& expression, python::object& scope,
+                 std::vector<T>& values)
+{
+    values.clear();
+    return handler.FromPythonArray(Eval(expression, scope), values);
+}
+
+
+// Memoryviews share the values memory, numpy wraps them without copy.
+static void CheckToPython(python::object& scope)
+{
+    std::vector<int> ints = {1, 2, 3, 4};
+    scope["view"] = TSys::IntHandler().ToPythonArray(ints.data(), ints.size());
+
+    TSYS_CHECK(True("isinstance(view, memoryview) and view.readonly", scope));
+    TSYS_CHECK(True("view.format == 'i' and view.tolist() == [1, 2, 3, 4]", scope));
+
+    scope["wrapped"] = Eval("numpy.asarray(view)", scope);
+    TSYS_CHECK(True("wrapped.dtype == numpy.int32 and not wrapped.flags.writeable", scope));
+
+    uintptr_t address = python::extract<uintptr_t>(Eval("wrapped.ctypes.data", scope));
+    TSYS_CHECK(address == reinterpret_cast<uintptr_t>(ints.data()));
+
+    ints[2] = 30;
+    TSYS_CHECK(True("view[2] == 30 and wrapped[2] == 30", scope));
+
+    std::vector<float> floats = {0.5f, 1.5f};
+    scope["view"] = TSys::FloatHandler().ToPythonArray(floats.data(), floats.size());
+    TSYS_CHECK(True("view.format == 'f' and view.tolist() == [0.5, 1.5]", scope));
+
+    std::vector<double> doubles = {0.25, -8.0, 1e300};
+    scope["view"] = TSys::DoubleHandler().ToPythonArray(doubles.data(), doubles.size());
+    TSYS_CHECK(True("view.format == 'd' and view.tolist() == [0.25, -8.0, 1e300]", scope));
+
+    scope["view"] = TSys::DoubleHandler().ToPythonArray(doubles.data(), 0);
+    TSYS_CHECK(True("len(view) == 0 and numpy.asarray(view).size == 0", scope));
+}
+
+
+// Strided and 2-D buffers are read in C order.
+static void CheckLayouts(python::object& scope)
+{
+    TSys::IntHandler handler;
+
+    python::exec("matrix = numpy.arange(6, dtype=numpy.int32).reshape(2, 3)", scope, scope);
+
+    std::vector<int> values;
+    TSYS_CHECK(Read(handler, "numpy.arange(10, dtype=numpy.int32)[::2]", scope, values));
+    TSYS_CHECK((values == std::vector<int>{0, 2, 4, 6, 8}));
+
+    TSYS_CHECK(Read(handler, "numpy.arange(10, dtype=numpy.int32)[::-3]", scope, values));
+    TSYS_CHECK((values == std::vector<int>{9, 6, 3, 0}));
+
+    TSYS_CHECK(Read(handler, "matrix", scope, values));
+    TSYS_CHECK((values == std::vector<int>{0, 1, 2, 3, 4, 5}));
+
+    TSYS_CHECK(Read(handler, "numpy.asfortranarray(matrix)", scope, values));
+    TSYS_CHECK((values == std::vector<int>{0, 1, 2, 3, 4, 5}));
+
+    TSYS_CHECK(Read(handler, "matrix.T", scope, values));
+    TSYS_CHECK((values == std::vector<int>{0, 3, 1, 4, 2, 5}));
+
+    TSYS_CHECK(Read(handler, "matrix[:, 1:]", scope, values));
+    TSYS_CHECK((values == std::vector<int>{1, 2, 4, 5}));
+
+    TSYS_CHECK(Read(handler, "numpy.zeros((0, 3), dtype=numpy.int32)", scope, values));
+    TSYS_CHECK(values.empty());
+}
+
+
+// Numeric items of other types are converted.
+static void CheckItemTypes(python::object& scope)
+{
+    TSys::IntHandler intHandler;
+    TSys::FloatHandler floatHandler;
+    TSys::DoubleHandler doubleHandler;
+
+    std::vector<int> ints;
+    TSYS_CHECK(Read(intHandler, "numpy.array([1.5, -2.5, 3.0])", scope, ints));
+    TSYS_CHECK((ints == std::vector<int>{1, -2, 3}));
+
+    TSYS_CHECK(Read(intHandler, "numpy.array([1.5, -2.5, 3.0])[::2]", scope, ints));
+    TSYS_CHECK((ints == std::vector<int>{1, 3}));
+
+    TSYS_CHECK(Read(intHandler, "numpy.array([200, 7], dtype=numpy.uint8)", scope, ints));
+    TSYS_CHECK((ints == std::vector<int>{200, 7}));
+
+    TSYS_CHECK(Read(intHandler, "numpy.array([-(2 ** 40), 5], dtype=numpy.int64)[1:]", scope, ints));
+    TSYS_CHECK((ints == std::vector<int>{5}));
+
+    std::vector<float> floats;
+    TSYS_CHECK(Read(floatHandler, "numpy.array([True, False])", scope, floats));
+    TSYS_CHECK((floats == std::vector<float>{1.0f, 0.0f}));
+
+    TSYS_CHECK(Read(floatHandler, "numpy.array([0.5, 0.25], dtype=numpy.float64)", scope, floats));
+    TSYS_CHECK((floats == std::vector<float>{0.5f, 0.25f}));
+
+    std::vector<double> doubles;
+    TSYS_CHECK(Read(doubleHandler, "numpy.array([1, -2], dtype=numpy.int16)", scope, doubles));
+    TSYS_CHECK((doubles == std::vector<double>{1.0, -2.0}));
+
+    TSYS_CHECK(Read(doubleHandler, "numpy.array([0.1], dtype=numpy.float32)", scope, doubles));
+    TSYS_CHECK((doubles == std::vector<double>{(double)0.1f}));
+
+    // Standard library buffers.
+    TSYS_CHECK(Read(doubleHandler, "array.array('h', [3, -4])", scope, doubles));
+    TSYS_CHECK((doubles == std::vector<double>{3.0, -4.0}));
+
+    TSYS_CHECK(Read(intHandler, "memoryview(array.array('d', [7.0, 8.5]))", scope, ints));
+    TSYS_CHECK((ints == std::vector<int>{7, 8}));
+}
+
+
+// Objects without buffer, or with items that are not native numbers.
+static void CheckRejected(python::object& scope)
+{
+    TSys::DoubleHandler handler;
+
+    const char* rejected[] = {
+            "[1.0, 2.0]",
+            "(1.0, 2.0)",
+            "'1.0'",
+            "None",
+            "1.0",
+            "numpy.array([1, 'a'], dtype=object)",
+            "numpy.zeros(2, dtype=numpy.complex64)",
+            "numpy.zeros(2, dtype=[('x', numpy.int32), ('y', numpy.float32)])",
+            "numpy.arange(3).astype(numpy.dtype(numpy.int32).newbyteorder())",
+            "numpy.arange(3.0).astype(numpy.dtype(numpy.float64).newbyteorder())"
+    };
+
+    for (const char* expression : rejected)
+    {
+        std::vector<double> values;
+        TSYS_CHECK(!Read(handler, expression, scope, values));
+        TSYS_CHECK(!PyErr_Occurred());
+    }
+}
+
+
+int main()
+{
+    Py_Initialize();
+
+    python::object scope = python::import("__main__").attr("__dict__");
+
+    try
+    {
+        scope["numpy"] = python::import("numpy");
+        scope["array"] = python::import("array");
+    }
+    catch (const python::error_already_set&)
+    {
+        PyErr_Clear();
+        std::printf("numpy is not installed, skipping\n");
+        return SkipCode;
+    }
+
+    try
+    {
+        CheckToPython(scope);
+        CheckLayouts(scope);
+        CheckItemTypes(scope);
+        CheckRejected(scope);
+    }
+    catch (const python::error_already_set&)
+    {
+        PyErr_Print();
+        TSYS_CHECK(false);
+    }
+
+    return 0;
+}
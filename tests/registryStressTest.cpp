@@ -0,0 +1,123 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "tests/testing.h"
+
+
+// Types only used to reserve new ids while readers run.
+template<size_t N>
+struct Tag {};
+
+
+// Source of a converter registered on the live int handler.
+struct Marker {};
+
+
+static constexpr size_t TagCount = 64;
+
+static constexpr size_t WriterIterations = 2000;
+
+
+template<size_t... N>
+static std::vector<TSys::TypeId (*)()> Reservations(std::index_sequence<N...>)
+{
+    return {&TSys::TypeIdOf<Tag<N>>...};
+}
+
+
+// Looks types up and converts through whichever handlers are
+// currently registered, until the writer is done.
+static void Read(const std::atomic<bool>& done, std::atomic<size_t>& reads)
+{
+    auto registry = TSys::TypeRegistry::GetRegistry();
+
+    size_t count = 0;
+    while (!done.load(std::memory_order_acquire))
+    {
+        TSys::TypeHandlerPtr handler = registry->GetTypeHandle<int>();
+        TSYS_CHECK(handler);
+        TSYS_CHECK(registry->GetTypeHandle("Int"));
+        TSYS_CHECK(registry->GetTypeId(std::type_index(typeid(float))) != TSys::InvalidTypeId);
+
+        std::any result = handler->ConvertFrom(std::make_any<float>(2.5f), handler->InitValue());
+
+        // The handler may have been replaced meanwhile, it then only
+        // converts through its own converters, which include float.
+        const int* value = std::any_cast<int>(&result);
+        TSYS_CHECK(value && *value == 2);
+
+        std::any marker = handler->ConvertFrom(std::make_any<Marker>(), handler->InitValue());
+        TSYS_CHECK(!marker.has_value() || std::any_cast<int>(marker) == 7);
+
+        float floats[5] = {0.5f, 1.5f, -2.5f, 3.0f, 4.75f};
+        int ints[5] = {};
+        TSYS_CHECK(handler->ConvertMany(floats, ints, 5));
+        TSYS_CHECK(ints[2] == -2 && ints[4] == 4);
+
+        count++;
+    }
+
+    reads.fetch_add(count, std::memory_order_relaxed);
+}
+
+
+int main()
+{
+    auto registry = TSys::TypeRegistry::GetRegistry();
+    auto reservations = Reservations(std::make_index_sequence<TagCount>());
+
+    std::atomic<bool> done{false};
+    std::atomic<size_t> reads{0};
+
+    unsigned readerCount = std::max(2u, std::thread::hardware_concurrency());
+    std::vector<std::thread> readers;
+    for (unsigned i = 0; i < readerCount; i++)
+    {
+        readers.emplace_back(Read, std::cref(done), std::ref(reads));
+    }
+
+    for (size_t i = 0; i < WriterIterations; i++)
+    {
+        switch (i % 3)
+        {
+            case 0:
+                TSYS_CHECK((registry->RegisterType<int, TSys::IntHandler>(true)));
+                break;
+
+            case 1:
+                registry->GetTypeHandle<int>()->RegisterConverter<Marker>(
+                        [](const std::any&, const std::any&) { return std::make_any<int>(7); }
+                );
+                break;
+
+            default:
+                TSYS_CHECK((reservations[i % TagCount]() != TSys::InvalidTypeId));
+                break;
+        }
+    }
+
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    TSYS_CHECK(reads.load() > 0);
+
+    // Registered converters are visible once the writer is done.
+    auto handler = registry->GetTypeHandle<int>();
+    handler->RegisterConverter<Marker>(
+            [](const std::any&, const std::any&) { return std::make_any<int>(7); }
+    );
+    TSYS_CHECK(handler->CanConvertFrom(std::make_any<Marker>()));
+    TSYS_CHECK(std::any_cast<int>(handler->ConvertFrom(std::make_any<Marker>(),
+                                                       handler->InitValue())) == 7);
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include "include/tsys.h"
+#include "include/defaultTypes.h"
+
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include "tests/testing.h"
+
+
+template<class T, class S>
+static std::any Convert(const S& source)
+{
+    auto handler = TSys::TypeRegistry::GetRegistry()->GetTypeHandle<T>();
+
+    return handler->ConvertFrom(std::make_any<S>(source), handler->InitValue());
+}
+
+
+template<class N>
+static std::string ToString(N value)
+{
+    return std::any_cast<std::string>(Convert<std::string>(value));
+}
+
+
+// Converted value, or fallback when the conversion failed.
+template<class N>
+static N FromString(const std::string& str, N fallback)
+{
+    std::any value = Convert<N>(str);
+    return value.has_value() ? std::any_cast<N>(value) : fallback;
+}
+
+
+// Shortest text that reads back to the same value.
+static void CheckFormatting()
+{
+    TSYS_CHECK(ToString(1.5f) == "1.5");
+    TSYS_CHECK(ToString(0.1f) == "0.1");
+    TSYS_CHECK(ToString(0.1) == "0.1");
+    TSYS_CHECK(ToString(-2.0) == "-2");
+    TSYS_CHECK(ToString(1e-7f) == "1e-07");
+    TSYS_CHECK(ToString(0) == "0");
+    TSYS_CHECK(ToString(-42) == "-42");
+    TSYS_CHECK(ToString(std::numeric_limits<int>::min()) == "-2147483648");
+
+    for (double value : {1.0 / 3.0, 2.0 / 3.0, 1e300, 5e-324, -123456.789})
+    {
+        TSYS_CHECK(FromString(ToString(value), 0.0) == value);
+    }
+
+    for (float value : {1.0f / 3.0f, 3.4e38f, 1e-45f, -123456.79f})
+    {
+        TSYS_CHECK(FromString(ToString(value), 0.0f) == value);
+    }
+}
+
+
+static void CheckParsing()
+{
+    TSYS_CHECK(FromString<int>("42", 0) == 42);
+    TSYS_CHECK(FromString<int>("-42", 0) == -42);
+    TSYS_CHECK(FromString<int>("+42", 0) == 42);
+    TSYS_CHECK(FromString<int>(" \t\n42", 0) == 42);
+    TSYS_CHECK(FromString<int>("  +7", 0) == 7);
+
+    TSYS_CHECK(FromString<float>("+1.5", 0.0f) == 1.5f);
+    TSYS_CHECK(FromString<float>(" 0.1", 0.0f) == 0.1f);
+    TSYS_CHECK(FromString<double>("  -2.5e3", 0.0) == -2500.0);
+    TSYS_CHECK(FromString<double>("+0.1", 0.0) == 0.1);
+
+    // The number at the start of the string is read, as std::sto* do.
+    TSYS_CHECK(FromString<int>("12abc", 0) == 12);
+    TSYS_CHECK(FromString<int>("3.75", 0) == 3);
+    TSYS_CHECK(FromString<double>("1.5 meters", 0.0) == 1.5);
+
+    // Empty, blank, signs only and invalid input do not convert.
+    for (const char* invalid : {"", " ", "+", "-", "+-1", "++1", "abc", "x12", "\t"})
+    {
+        TSYS_CHECK(!Convert<int>(std::string(invalid)).has_value());
+        TSYS_CHECK(!Convert<float>(std::string(invalid)).has_value());
+        TSYS_CHECK(!Convert<double>(std::string(invalid)).has_value());
+        TSYS_CHECK(!Convert<bool>(std::string(invalid)).has_value());
+    }
+
+    // Out of range.
+    TSYS_CHECK(!Convert<int>(std::string("99999999999")).has_value());
+    TSYS_CHECK(!Convert<float>(std::string("1e100")).has_value());
+}
+
+
+static void CheckBool()
+{
+    TSYS_CHECK(FromString<bool>("true", false) == true);
+    TSYS_CHECK(FromString<bool>("false", true) == false);
+
+    // Numbers are true when not zero.
+    TSYS_CHECK(FromString<bool>("1", false) == true);
+    TSYS_CHECK(FromString<bool>("0", true) == false);
+    TSYS_CHECK(FromString<bool>("0.0", true) == false);
+    TSYS_CHECK(FromString<bool>(" -0.5", false) == true);
+
+    TSYS_CHECK(!Convert<bool>(std::string("True")).has_value());
+    TSYS_CHECK(!Convert<bool>(std::string("yes")).has_value());
+}
+
+
+int main()
+{
+    CheckFormatting();
+    CheckParsing();
+    CheckBool();
+
+    return 0;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+
+// Reports failed condition and exits, tests are plain executables run by ctest.
+#define TSYS_CHECK(condition)                                                       \
+    do                                                                              \
+    {                                                                               \
+        if (!(condition))                                                           \
+        {                                                                           \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n",                       \
+                         __FILE__, __LINE__, #condition);                           \
+            std::exit(EXIT_FAILURE);                                                \
+        }                                                                           \
+    } while (false)